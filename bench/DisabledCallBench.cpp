@@ -0,0 +1,77 @@
+// Shows that statements below SIMPLELOGGER_ACTIVE_LEVEL cost nothing: the
+// loop with disabled LOG_DEBUG/LOG_TRACE calls must take as many cycles as
+// the empty loop, and their arguments must never be evaluated.
+//
+// The build links it against a library compiled at INFO, so it measures the
+// same thing whatever SIMPLELOGGER_ACTIVE_LEVEL the main library uses.
+
+#include "SimpleLogger/SimpleLogger.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+static_assert(SIMPLELOGGER_ACTIVE_LEVEL == SIMPLELOGGER_LEVEL_INFO, "benchmark expects DEBUG and TRACE compiled out");
+
+namespace
+{
+	constexpr uint64_t Iterations = 100'000'000;
+
+	uint64_t s_Evaluations = 0;
+
+	int expensiveArgument()
+	{
+		s_Evaluations++;
+		return static_cast<int>(s_Evaluations);
+	}
+
+	uint64_t cycles()
+	{
+#if defined(__x86_64__) || defined(_M_X64)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	// Keeps the compiler from deleting the loop itself.
+	inline void barrier()
+	{
+#if defined(__GNUC__)
+		asm volatile("" ::: "memory");
+#endif
+	}
+
+	template <typename Body>
+	double cyclesPerIteration(Body body)
+	{
+		const uint64_t start = cycles();
+		for (uint64_t i = 0; i < Iterations; i++)
+		{
+			body(i);
+			barrier();
+		}
+		return static_cast<double>(cycles() - start) / static_cast<double>(Iterations);
+	}
+}
+
+int main()
+{
+	const double baseline = cyclesPerIteration([](uint64_t) {});
+	const double disabled = cyclesPerIteration([](uint64_t i)
+	{
+		LOG_DEBUG("value {} at {}", expensiveArgument(), i);
+		LOG_TRACE("trace {}", expensiveArgument());
+	});
+
+	std::printf("empty loop:        %.3f cycles/iteration\n", baseline);
+	std::printf("disabled LOG_*:    %.3f cycles/iteration\n", disabled);
+	std::printf("overhead:          %.3f cycles/iteration\n", disabled - baseline);
+	std::printf("argument evaluated %llu times\n", static_cast<unsigned long long>(s_Evaluations));
+
+	return s_Evaluations == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Compares the escaping kernels on long payloads: mostly plain text with an
+// occasional quote, newline or control character, like a log of request
+// bodies. Every kernel the CPU supports must produce the scalar output byte
+// for byte, or the benchmark fails.
+
+#include "SimpleLogger/Escape.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+using namespace SimpleLogger;
+
+namespace
+{
+	constexpr size_t PayloadSize = 1 << 20;
+	constexpr int Rounds = 50;
+
+	std::string makePayload()
+	{
+		const char specials[] = { '"', '\n', '\\', '\x1b', ' ', '=', '\t', '\r' };
+		std::string payload(PayloadSize, ' ');
+		uint32_t state = 12345;
+		for (size_t i = 0; i < payload.size(); i++)
+		{
+			state = state * 1103515245 + 12345;
+			payload[i] = static_cast<char>('a' + (state >> 16) % 26);
+			if ((state >> 8) % 97 == 0)
+				payload[i] = specials[(state >> 4) % sizeof(specials)];
+		}
+		return payload;
+	}
+
+	template <typename Append>
+	double megabytesPerSecond(const std::string& payload, std::string& out, Append append)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int round = 0; round < Rounds; round++)
+		{
+			out.clear();
+			append(payload, out);
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return static_cast<double>(payload.size()) * Rounds / elapsed.count() / 1e6;
+	}
+}
+
+int main()
+{
+	const Escape::Kernel detected = Escape::activeKernel();
+	const std::string payload = makePayload();
+	std::string expectedJson, expectedText, expectedLogfmt;
+	bool mismatch = false;
+
+	for (Escape::Kernel kernel : { Escape::Kernel::Scalar, Escape::Kernel::Sse2, Escape::Kernel::Avx2, Escape::Kernel::Neon })
+	{
+		if (!Escape::useKernel(kernel))
+			continue;
+
+		std::string json, text, logfmt;
+		const double jsonSpeed = megabytesPerSecond(payload, json, Escape::appendJson);
+		const double textSpeed = megabytesPerSecond(payload, text, Escape::appendText);
+		const double logfmtSpeed = megabytesPerSecond(payload, logfmt, Escape::appendLogfmt);
+		std::printf("%-7s json %8.1f MB/s   text %8.1f MB/s   logfmt %8.1f MB/s\n",
+			Escape::kernelName(kernel), jsonSpeed, textSpeed, logfmtSpeed);
+
+		if (kernel == Escape::Kernel::Scalar)
+		{
+			expectedJson = json;
+			expectedText = text;
+			expectedLogfmt = logfmt;
+		}
+		else if (json != expectedJson || text != expectedText || logfmt != expectedLogfmt)
+		{
+			std::printf("%s output differs from scalar\n", Escape::kernelName(kernel));
+			mismatch = true;
+		}
+	}
+
+	Escape::useKernel(detected);
+	std::printf("selected at startup: %s\n", Escape::kernelName(detected));
+	return mismatch ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+// Measures what a log statement costs the calling thread and how many
+// records the backend sustains, in the style of the usual async logger
+// benchmarks:
+//
+//  - Latency: 1, 4, 16 and 64 threads log in bursts of BurstSize statements
+//    with a short pause in between, so the backend can keep up and the
+//    numbers show the hot path rather than a full queue. Every statement is
+//    timed with the CPU tick counter; the table gives p50, p99, p99.9 and
+//    max in nanoseconds for each argument shape, next to std::cout writing
+//    the same line.
+//  - Throughput: one thread logs Messages records to each sink as fast as it
+//    can; the rate is measured up to the flush that writes out the last one.
+//
+// Output files go to the directory given as the first argument, or to a
+// fresh directory under the system temp directory, which is removed at the
+// end.
+
+#include "SimpleLogger/SimpleLogger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace SimpleLogger;
+
+namespace
+{
+	constexpr size_t ThreadCounts[] = { 1, 4, 16, 64 };
+	constexpr size_t Bursts = 250;
+	constexpr size_t BurstSize = 20;
+	constexpr std::chrono::microseconds BurstPause{ 50 };
+	constexpr size_t Messages = 1'000'000;
+
+	const std::string s_LongString(200, 'x');
+
+	// Formats every record, like a real text sink, but writes nothing.
+	class NullSink final : public Sink
+	{
+	public:
+		void write(const LogEvent& event) override { m_Bytes += event.line.size(); }
+		void flush() override {}
+
+	private:
+		size_t m_Bytes = 0;
+	};
+
+	// One way of calling the logger; `i` varies the arguments a little.
+	struct Shape
+	{
+		const char* name;
+		std::function<void(Logger&, uint64_t)> log;
+		// The same line through std::cout, for the baseline.
+		std::function<void(uint64_t)> print;
+	};
+
+	std::vector<Shape> shapes()
+	{
+		return {
+			{ "no arguments",
+				[](Logger& logger, uint64_t) { LOGGER_INFO(logger, "static message without arguments"); },
+				[](uint64_t) { std::cout << "static message without arguments\n"; } },
+			{ "int, double, literal",
+				[](Logger& logger, uint64_t i) { LOGGER_INFO(logger, "request {} took {:.3f} ms from {}", i, static_cast<double>(i) * 0.25, "client"); },
+				[](uint64_t i) { std::cout << "request " << i << " took " << std::fixed << std::setprecision(3) << static_cast<double>(i) * 0.25 << " ms from client\n"; } },
+			{ "200 byte std::string",
+				[](Logger& logger, uint64_t) { LOGGER_INFO(logger, "payload {}", s_LongString); },
+				[](uint64_t) { std::cout << "payload " << s_LongString << '\n'; } },
+			{ "kv fields",
+				[](Logger& logger, uint64_t i) { LOGGER_INFO(logger, "done", kv("id", i), kv("user", "alice"), kv("ok", true)); },
+				[](uint64_t i) { std::cout << "done id=" << i << " user=alice ok=" << true << '\n'; } },
+		};
+	}
+
+	struct Percentiles
+	{
+		double p50, p99, p999, max;
+	};
+
+	Percentiles percentiles(std::vector<uint64_t>& ticks, double nanosecondsPerTick)
+	{
+		std::sort(ticks.begin(), ticks.end());
+		const auto at = [&](double fraction)
+		{
+			const size_t index = std::min(ticks.size() - 1, static_cast<size_t>(fraction * static_cast<double>(ticks.size())));
+			return static_cast<double>(ticks[index]) * nanosecondsPerTick;
+		};
+		return { at(0.50), at(0.99), at(0.999), static_cast<double>(ticks.back()) * nanosecondsPerTick };
+	}
+
+	// Runs call on `threads` threads at once, Bursts * BurstSize times each,
+	// and returns the ticks every call took. warmup runs first on each thread,
+	// outside the measurement.
+	std::vector<uint64_t> measure(size_t threads, const std::function<void()>& warmup, const std::function<void(uint64_t)>& call)
+	{
+		std::vector<std::vector<uint64_t>> samples(threads);
+		std::atomic<size_t> ready{ 0 };
+		std::atomic<bool> start{ false };
+
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++)
+		{
+			workers.emplace_back([&, t]
+			{
+				std::vector<uint64_t>& ticks = samples[t];
+				ticks.reserve(Bursts * BurstSize);
+				warmup();
+				ready.fetch_add(1);
+				while (!start.load())
+					std::this_thread::yield();
+
+				uint64_t i = 0;
+				for (size_t burst = 0; burst < Bursts; burst++)
+				{
+					for (size_t n = 0; n < BurstSize; n++, i++)
+					{
+						const uint64_t begin = now();
+						call(i);
+						ticks.push_back(now() - begin);
+					}
+					std::this_thread::sleep_for(BurstPause);
+				}
+			});
+		}
+		while (ready.load() < threads)
+			std::this_thread::yield();
+		start.store(true);
+		for (std::thread& worker : workers)
+			worker.join();
+
+		std::vector<uint64_t> all;
+		all.reserve(threads * Bursts * BurstSize);
+		for (const std::vector<uint64_t>& ticks : samples)
+			all.insert(all.end(), ticks.begin(), ticks.end());
+		return all;
+	}
+
+	void printRow(const char* what, size_t threads, const char* shape, std::vector<uint64_t> ticks, double nanosecondsPerTick)
+	{
+		const Percentiles p = percentiles(ticks, nanosecondsPerTick);
+		std::printf("%-12s %7zu  %-22s %9.1f %9.1f %9.1f %11.1f\n", what, threads, shape, p.p50, p.p99, p.p999, p.max);
+		std::fflush(stdout);
+	}
+
+	// Points stdout at path for as long as it lives, so that the std::cout
+	// baseline keeps its usual synchronisation with stdio.
+	class StdoutRedirect
+	{
+	public:
+		explicit StdoutRedirect(const std::filesystem::path& path)
+		{
+			std::cout.flush();
+			std::fflush(stdout);
+			m_Saved = ::dup(STDOUT_FILENO);
+			const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			::dup2(fd, STDOUT_FILENO);
+			::close(fd);
+		}
+
+		~StdoutRedirect()
+		{
+			std::cout.flush();
+			std::fflush(stdout);
+			::dup2(m_Saved, STDOUT_FILENO);
+			::close(m_Saved);
+		}
+
+		StdoutRedirect(const StdoutRedirect&) = delete;
+		StdoutRedirect& operator=(const StdoutRedirect&) = delete;
+
+	private:
+		int m_Saved = -1;
+	};
+
+	void latency(const std::filesystem::path& directory, double nanosecondsPerTick)
+	{
+		std::printf("call latency, ns (%zu bursts of %zu per thread)\n", Bursts, BurstSize);
+		std::printf("%-12s %7s  %-22s %9s %9s %9s %11s\n", "", "threads", "arguments", "p50", "p99", "p99.9", "max");
+
+		for (const Shape& shape : shapes())
+		{
+			for (size_t threads : ThreadCounts)
+			{
+				std::vector<uint64_t> ticks;
+				{
+					Logger logger("bench", { std::make_shared<FileSink>(directory / "latency.log", FlushPolicy{}, true) });
+					logger.setOverflowPolicy(OverflowPolicy::Block);
+					ticks = measure(threads, [&] { shape.log(logger, 0); }, [&](uint64_t i) { shape.log(logger, i); });
+				}
+				printRow("SimpleLogger", threads, shape.name, std::move(ticks), nanosecondsPerTick);
+			}
+			for (size_t threads : ThreadCounts)
+			{
+				std::vector<uint64_t> ticks;
+				{
+					StdoutRedirect redirect(directory / "cout.log");
+					ticks = measure(threads, [&] { shape.print(0); }, shape.print);
+				}
+				printRow("std::cout", threads, shape.name, std::move(ticks), nanosecondsPerTick);
+			}
+		}
+	}
+
+	void printRate(const char* what, std::chrono::steady_clock::duration elapsed)
+	{
+		const double seconds = std::chrono::duration<double>(elapsed).count();
+		std::printf("%-22s %12.0f msg/s %9.1f ns/msg\n", what, static_cast<double>(Messages) / seconds, seconds * 1e9 / static_cast<double>(Messages));
+		std::fflush(stdout);
+	}
+
+	void throughput(const char* name, std::shared_ptr<Sink> sink)
+	{
+		Logger logger("bench", { std::move(sink) });
+		logger.setOverflowPolicy(OverflowPolicy::Block);
+		LOGGER_INFO(logger, "warmup");
+		Backend::instance().flush();
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint64_t i = 0; i < Messages; i++)
+			LOGGER_INFO(logger, "request {} took {:.3f} ms from {}", i, static_cast<double>(i) * 0.25, "client");
+		Backend::instance().flush();
+		printRate(name, std::chrono::steady_clock::now() - start);
+	}
+
+	void throughput(const std::filesystem::path& directory)
+	{
+		std::printf("\nbackend throughput, %zu records of \"request {} took {:.3f} ms from {}\"\n", Messages);
+
+		throughput("null (format only)", std::make_shared<NullSink>());
+		throughput("FileSink", std::make_shared<FileSink>(directory / "file.log", FlushPolicy{}, true));
+		throughput("UringFileSink", std::make_shared<UringFileSink>(directory / "uring.log", FlushPolicy{}, UringOptions{}, true));
+		throughput("MmapSink", std::make_shared<MmapSink>(directory / "mmap.log"));
+		throughput("BinarySink", std::make_shared<BinarySink>(directory / "binary.sbl"));
+		throughput("AsyncSink(FileSink)", std::make_shared<AsyncSink>(std::make_shared<FileSink>(directory / "async.log", FlushPolicy{}, true)));
+		if (codecAvailable(Codec::Zstd))
+			throughput("CompressedFileSink zstd", std::make_shared<CompressedFileSink>(directory / "file.log.zst", CompressionOptions{ Codec::Zstd }));
+		if (codecAvailable(Codec::Lz4))
+			throughput("CompressedFileSink lz4", std::make_shared<CompressedFileSink>(directory / "file.log.lz4", CompressionOptions{ Codec::Lz4 }));
+
+		std::chrono::steady_clock::duration elapsed;
+		{
+			StdoutRedirect redirect(directory / "cout.log");
+			const auto start = std::chrono::steady_clock::now();
+			for (uint64_t i = 0; i < Messages; i++)
+				std::cout << "request " << i << " took " << std::fixed << std::setprecision(3) << static_cast<double>(i) * 0.25 << " ms from client\n";
+			std::cout.flush();
+			elapsed = std::chrono::steady_clock::now() - start;
+		}
+		printRate("std::cout (caller)", elapsed);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool temporary = argc < 2;
+	const std::filesystem::path directory = temporary
+		? std::filesystem::temp_directory_path() / ("simplelogger_bench." + std::to_string(::getpid()))
+		: std::filesystem::path(argv[1]);
+	std::filesystem::create_directories(directory);
+
+	TickConverter clock;
+	clock.calibrate();
+
+	latency(directory, clock.nanosecondsPerTick());
+	throughput(directory);
+
+	if (temporary)
+		std::filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace SimpleLogger
+{
+	// Wire type of one argument in a record payload. Values are stored
+	// unaligned in native byte order; strings are a uint32_t length followed
+	// by the bytes, without a terminator.
+	enum class ArgType : uint8_t
+	{
+		Bool,
+		Char,
+		Int32,
+		Int64,
+		UInt32,
+		UInt64,
+		Float,
+		Double,
+		Pointer,
+		String,
+		// Pointer and uint32_t length of a string with static storage
+		// duration. Only valid inside the process; BinarySink writes these
+		// out as String.
+		StaticString,
+		// Name of a structured field (see kv()); the field's value is the
+		// next argument. Encoded like String.
+		Key,
+		// Key with static storage, encoded like StaticString. BinarySink
+		// writes these out as Key.
+		StaticKey
+	};
+
+	// A string that outlives the program's logging, such as a literal or a
+	// global table entry. Only its address is captured, not its bytes:
+	//
+	//   LOG_INFO("state is {}", static_str(StateNames[state]));
+	struct StaticString
+	{
+		std::string_view value;
+	};
+
+	constexpr StaticString static_str(std::string_view value)
+	{
+		return StaticString{ value };
+	}
+
+	// A named value for structured logging. Fields follow the positional
+	// arguments and don't take a placeholder; text sinks print them after the
+	// message as key=value, JSON and logfmt sinks as fields of their own:
+	//
+	//   LOG_INFO("request done", kv("user", id), kv("lat_us", micros));
+	//
+	// The key must be a string literal, as only its address is captured. The
+	// value is referenced until the statement has copied it.
+	template <typename T>
+	struct Field
+	{
+		std::string_view key;
+		T&& value;
+	};
+
+	template <size_t N, typename T>
+	constexpr Field<T> kv(const char (&key)[N], T&& value)
+	{
+		return Field<T>{ std::string_view(key, N - 1), std::forward<T>(value) };
+	}
+
+	namespace detail
+	{
+		template <typename T>
+		inline constexpr bool IsStringLike = std::is_same_v<T, const char*> || std::is_same_v<T, char*>
+			|| std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+		template <typename T>
+		struct ArgTraits;
+
+		template <typename T>
+			requires std::is_enum_v<T>
+		struct ArgTraits<T> : ArgTraits<std::underlying_type_t<T>>
+		{
+		};
+
+		template <typename T>
+			requires std::is_integral_v<T> && (!std::is_same_v<T, bool>) && (!std::is_same_v<T, char>)
+		struct ArgTraits<T>
+		{
+			using Stored = std::conditional_t<std::is_signed_v<T>,
+				std::conditional_t<(sizeof(T) <= 4), int32_t, int64_t>,
+				std::conditional_t<(sizeof(T) <= 4), uint32_t, uint64_t>>;
+
+			static constexpr ArgType Type = std::is_signed_v<T>
+				? (sizeof(T) <= 4 ? ArgType::Int32 : ArgType::Int64)
+				: (sizeof(T) <= 4 ? ArgType::UInt32 : ArgType::UInt64);
+		};
+
+		template <>
+		struct ArgTraits<bool>
+		{
+			using Stored = bool;
+			static constexpr ArgType Type = ArgType::Bool;
+		};
+
+		template <>
+		struct ArgTraits<char>
+		{
+			using Stored = char;
+			static constexpr ArgType Type = ArgType::Char;
+		};
+
+		template <>
+		struct ArgTraits<float>
+		{
+			using Stored = float;
+			static constexpr ArgType Type = ArgType::Float;
+		};
+
+		template <>
+		struct ArgTraits<double>
+		{
+			using Stored = double;
+			static constexpr ArgType Type = ArgType::Double;
+		};
+
+		template <typename T>
+			requires std::is_pointer_v<T> && (!IsStringLike<T>)
+		struct ArgTraits<T>
+		{
+			using Stored = uintptr_t;
+			static constexpr ArgType Type = ArgType::Pointer;
+		};
+
+		template <typename T>
+			requires IsStringLike<T>
+		struct ArgTraits<T>
+		{
+			static constexpr ArgType Type = ArgType::String;
+		};
+
+		template <>
+		struct ArgTraits<StaticString>
+		{
+			static constexpr ArgType Type = ArgType::StaticString;
+		};
+
+		// True for arguments of type const char(&)[N], i.e. string literals.
+		// Arguments are taken by forwarding reference, so a mutable char buffer
+		// is char(&)[N] and still copied; a const char array that isn't static
+		// must be passed as a pointer or string_view to be copied.
+		template <typename T>
+		inline constexpr bool IsStringLiteral = std::is_array_v<std::remove_reference_t<T>>
+			&& std::is_same_v<std::remove_extent_t<std::remove_reference_t<T>>, const char>;
+
+		// The type an argument is captured as. T may be a reference: literals
+		// become StaticString, other arrays decay to pointers and are copied as
+		// strings.
+		template <typename T>
+		using ArgDecay = std::conditional_t<IsStringLiteral<T>, StaticString, std::decay_t<T>>;
+
+		template <typename T>
+		struct FieldTraits
+		{
+			static constexpr bool IsField = false;
+		};
+
+		// ValueType is the value's declared type, which the encoder needs to
+		// tell literals apart.
+		template <typename T>
+		struct FieldTraits<Field<T>>
+		{
+			static constexpr bool IsField = true;
+			using ValueType = T;
+		};
+
+		template <typename T>
+		inline constexpr bool IsField = FieldTraits<ArgDecay<T>>::IsField;
+
+		template <typename T>
+		struct LoggableCheck
+		{
+			static constexpr bool Value = requires { ArgTraits<ArgDecay<T>>::Type; };
+		};
+
+		template <typename T>
+			requires IsField<T>
+		struct LoggableCheck<T>
+		{
+			static constexpr bool Value = requires { ArgTraits<ArgDecay<typename FieldTraits<ArgDecay<T>>::ValueType>>::Type; };
+		};
+
+		template <typename T>
+		concept Loggable = LoggableCheck<T>::Value;
+
+		template <typename T>
+		constexpr bool isStringArg()
+		{
+			if constexpr (IsField<T>)
+				return isStringArg<typename FieldTraits<ArgDecay<T>>::ValueType>();
+			else
+				return ArgTraits<ArgDecay<T>>::Type == ArgType::String;
+		}
+
+		// Whether the argument (or a field's value) is a copied string.
+		template <typename T>
+		inline constexpr bool IsStringArg = isStringArg<T>();
+
+		template <typename T>
+		constexpr size_t fixedEncodedSize()
+		{
+			if constexpr (IsField<T>)
+				return sizeof(uintptr_t) + sizeof(uint32_t) + fixedEncodedSize<typename FieldTraits<ArgDecay<T>>::ValueType>();
+			else
+			{
+				using Traits = ArgTraits<ArgDecay<T>>;
+				if constexpr (Traits::Type == ArgType::String)
+					return sizeof(uint32_t);
+				else if constexpr (Traits::Type == ArgType::StaticString)
+					return sizeof(uintptr_t) + sizeof(uint32_t);
+				else
+					return sizeof(typename Traits::Stored);
+			}
+		}
+
+		inline std::string_view toStringView(const char* value) { return value ? std::string_view(value) : std::string_view("(null)"); }
+		inline std::string_view toStringView(std::string_view value) { return value; }
+
+		// T is the argument's declared type, which is what tells literals
+		// apart from other char arrays; value has lost that distinction.
+		template <typename T, typename V>
+		inline size_t variableSize(const V& value)
+		{
+			if constexpr (IsField<T>)
+				return variableSize<typename FieldTraits<ArgDecay<T>>::ValueType>(value.value);
+			else if constexpr (IsStringArg<T>)
+				return toStringView(value).size();
+			else
+				return 0;
+		}
+
+		inline size_t encodeStaticString(char* out, std::string_view text)
+		{
+			const uintptr_t data = reinterpret_cast<uintptr_t>(text.data());
+			const uint32_t length = static_cast<uint32_t>(text.size());
+			std::memcpy(out, &data, sizeof(data));
+			std::memcpy(out + sizeof(data), &length, sizeof(length));
+			return sizeof(data) + sizeof(length);
+		}
+
+		template <typename T, typename V>
+		inline size_t encodeValue(char* out, const V& value, size_t& stringBudget)
+		{
+			using Traits = ArgTraits<ArgDecay<T>>;
+			if constexpr (Traits::Type == ArgType::StaticString)
+			{
+				if constexpr (IsStringLiteral<T>)
+					return encodeStaticString(out, std::string_view(value, std::extent_v<std::remove_reference_t<T>> - 1));
+				else
+					return encodeStaticString(out, value.value);
+			}
+			else if constexpr (Traits::Type == ArgType::String)
+			{
+				const std::string_view text = toStringView(value);
+				const uint32_t length = static_cast<uint32_t>(text.size() < stringBudget ? text.size() : stringBudget);
+				stringBudget -= length;
+				std::memcpy(out, &length, sizeof(length));
+				std::memcpy(out + sizeof(length), text.data(), length);
+				return sizeof(length) + length;
+			}
+			else
+			{
+				typename Traits::Stored stored;
+				if constexpr (Traits::Type == ArgType::Pointer)
+					stored = reinterpret_cast<uintptr_t>(value);
+				else
+					stored = static_cast<typename Traits::Stored>(value);
+				std::memcpy(out, &stored, sizeof(stored));
+				return sizeof(stored);
+			}
+		}
+
+		// Writes one argument at out and returns the number of bytes used.
+		// Strings are cut to stringBudget bytes, which shrinks as they are
+		// written, so the record never overflows.
+		template <typename T, typename V>
+		inline size_t encodeArgument(char* out, const V& value, size_t& stringBudget)
+		{
+			if constexpr (IsField<T>)
+			{
+				const size_t keyLength = encodeStaticString(out, value.key);
+				return keyLength + encodeArgument<typename FieldTraits<ArgDecay<T>>::ValueType>(out + keyLength, value.value, stringBudget);
+			}
+			else
+			{
+				return encodeValue<T>(out, value, stringBudget);
+			}
+		}
+	}
+
+	template <typename... Args>
+	inline constexpr size_t FixedEncodedSize = (size_t(0) + ... + detail::fixedEncodedSize<Args>());
+
+	// Whether the encoded size depends on the values (i.e. there are strings).
+	template <typename... Args>
+	inline constexpr bool HasVariableSize = (false || ... || detail::IsStringArg<Args>);
+
+	// Exact size of the untruncated encoding.
+	template <typename... Args>
+	inline size_t encodedSize(Args&&... args)
+	{
+		return FixedEncodedSize<Args...> + (size_t(0) + ... + detail::variableSize<Args>(args));
+	}
+
+	namespace detail
+	{
+		// A field takes two entries in the metadata's type list: its key,
+		// then its value.
+		template <typename T>
+		constexpr void appendArgTypes(ArgType*& out)
+		{
+			if constexpr (IsField<T>)
+			{
+				*out++ = ArgType::StaticKey;
+				appendArgTypes<typename FieldTraits<ArgDecay<T>>::ValueType>(out);
+			}
+			else
+			{
+				*out++ = ArgTraits<ArgDecay<T>>::Type;
+			}
+		}
+
+		template <typename... Args>
+		constexpr auto makeArgTypes()
+		{
+			std::array<ArgType, (size_t(1) + ... + (IsField<Args> ? 2 : 1))> types{};
+			[[maybe_unused]] ArgType* out = types.data();
+			(appendArgTypes<Args>(out), ...);
+			return types;
+		}
+
+		template <typename... Args>
+		constexpr bool fieldsFollowPositional()
+		{
+			bool seenField = false;
+			bool ordered = true;
+			((IsField<Args> ? (seenField = true) : (ordered = ordered && !seenField)), ...);
+			return ordered;
+		}
+	}
+
+	// Number of "{}" placeholders the arguments fill; fields take none.
+	template <typename... Args>
+	inline constexpr size_t PositionalCount = (size_t(0) + ... + (detail::IsField<Args> ? 0 : 1));
+
+	template <typename... Args>
+	inline constexpr bool FieldsFollowPositional = detail::fieldsFollowPositional<Args...>();
+
+	// Type list for a call site's metadata, with an unused last entry so that
+	// it is never empty.
+	template <typename... Args>
+	inline constexpr auto ArgTypesList = detail::makeArgTypes<Args...>();
+
+	template <typename... Args>
+	inline constexpr const ArgType* ArgTypesOf = ArgTypesList<Args...>.data();
+
+	template <typename... Args>
+	inline constexpr uint8_t ArgTypeCount = static_cast<uint8_t>(ArgTypesList<Args...>.size() - 1);
+
+	// Serializes args into out (capacity bytes, at least FixedEncodedSize);
+	// returns the payload length. Strings are truncated to fit.
+	template <typename... Args>
+	inline size_t encodeArguments(char* out, size_t capacity, Args&&... args)
+	{
+		[[maybe_unused]] size_t stringBudget = capacity - FixedEncodedSize<Args...>;
+		size_t length = 0;
+		((length += detail::encodeArgument<Args>(out + length, args, stringBudget)), ...);
+		return length;
+	}
+
+	// Decoded view of one argument. String data points into the payload.
+	struct ArgValue
+	{
+		ArgType type;
+		union
+		{
+			bool b;
+			char c;
+			int64_t i;
+			uint64_t u;
+			float f;
+			double d;
+			uintptr_t p;
+		};
+		std::string_view s;
+	};
+
+	// Reads the argument of the given type at in and advances in past it.
+	// Static strings and keys decode like copied ones (type String or Key),
+	// cut at the first NUL since a literal's length comes from the size of
+	// its array.
+	inline ArgValue decodeArgument(ArgType type, const char*& in)
+	{
+		ArgValue value{};
+		value.type = type;
+		switch (type)
+		{
+		case ArgType::Bool:    std::memcpy(&value.b, in, sizeof(bool)); in += sizeof(bool); break;
+		case ArgType::Char:    std::memcpy(&value.c, in, sizeof(char)); in += sizeof(char); break;
+		case ArgType::Int32:   { int32_t v; std::memcpy(&v, in, sizeof(v)); in += sizeof(v); value.i = v; break; }
+		case ArgType::Int64:   std::memcpy(&value.i, in, sizeof(int64_t)); in += sizeof(int64_t); break;
+		case ArgType::UInt32:  { uint32_t v; std::memcpy(&v, in, sizeof(v)); in += sizeof(v); value.u = v; break; }
+		case ArgType::UInt64:  std::memcpy(&value.u, in, sizeof(uint64_t)); in += sizeof(uint64_t); break;
+		case ArgType::Float:   std::memcpy(&value.f, in, sizeof(float)); in += sizeof(float); break;
+		case ArgType::Double:  std::memcpy(&value.d, in, sizeof(double)); in += sizeof(double); break;
+		case ArgType::Pointer: std::memcpy(&value.p, in, sizeof(uintptr_t)); in += sizeof(uintptr_t); break;
+		case ArgType::String:
+		case ArgType::Key:
+		{
+			uint32_t length;
+			std::memcpy(&length, in, sizeof(length));
+			value.s = std::string_view(in + sizeof(length), length);
+			in += sizeof(length) + length;
+			break;
+		}
+		case ArgType::StaticKey:
+		case ArgType::StaticString:
+		{
+			uintptr_t data;
+			uint32_t length;
+			std::memcpy(&data, in, sizeof(data));
+			std::memcpy(&length, in + sizeof(data), sizeof(length));
+			in += sizeof(data) + sizeof(length);
+			value.type = type == ArgType::StaticKey ? ArgType::Key : ArgType::String;
+			value.s = std::string_view(reinterpret_cast<const char*>(data), length);
+			value.s = value.s.substr(0, value.s.find('\0'));
+			break;
+		}
+		}
+		return value;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Sink.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace SimpleLogger
+{
+	// Runs another sink on a thread of its own, so that a slow destination
+	// (a network collector, a congested disk) can't hold up the backend or
+	// the other sinks. The backend copies each event into a buffer that is
+	// handed to the worker between batches; if more than maxBufferedBytes
+	// are waiting, new events are dropped and counted instead.
+	//
+	//   auto collector = std::make_shared<AsyncSink>(std::make_shared<FileSink>("/mnt/nfs/app.log"));
+	//
+	// The wrapped sink's layout, pattern and wantsText() are taken over when
+	// the AsyncSink is created; its level still applies on the worker.
+	class AsyncSink final : public Sink
+	{
+	public:
+		explicit AsyncSink(std::shared_ptr<Sink> sink, size_t maxBufferedBytes = 8 * 1024 * 1024);
+		~AsyncSink() override;
+
+		void write(const LogEvent& event) override;
+		bool wantsText() const override { return m_WantsText; }
+
+		// Hands buffered events to the worker; never waits for it. Returns
+		// true until the worker has written everything out, so that a flush
+		// of the backend still reaches this sink.
+		bool poll() override;
+
+		// Hands buffered events to the worker and waits until it has written
+		// and flushed them.
+		void flush() override;
+
+		uint64_t droppedRecords() const { return m_Dropped.load(std::memory_order_relaxed); }
+		const std::shared_ptr<Sink>& sink() const { return m_Sink; }
+
+	private:
+		struct EntryHeader
+		{
+			uint64_t wallTime;
+			const Logger* logger;
+			const Metadata* metadata;
+			uint32_t payloadLength;
+			uint32_t lineLength;
+			uint32_t thread;
+			uint8_t threadNameLength;  // at most Record::PayloadSize
+			Level level;
+		};
+
+		// Moves m_Pending to the worker; returns false if m_Mutex was busy and
+		// wait is false.
+		bool handOver(bool wait);
+		void run();
+		void writeBatch(const std::string& batch);
+
+		const std::shared_ptr<Sink> m_Sink;
+		const size_t m_MaxBufferedBytes;
+		const bool m_WantsText;
+
+		// Backend thread only.
+		std::string m_Pending;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Wakeup;
+		std::condition_variable m_Flushed;
+		std::string m_Queued;
+		uint64_t m_FlushRequested = 0;
+		uint64_t m_FlushCompleted = 0;
+		bool m_Stopping = false;
+
+		std::atomic<size_t> m_QueuedBytes{ 0 };
+		std::atomic<bool> m_SinkHoldsData{ false };
+		std::atomic<uint64_t> m_Dropped{ 0 };
+		std::thread m_Thread;
+	};
+}
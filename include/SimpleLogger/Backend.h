@@ -0,0 +1,269 @@
+#pragma once
+
+#include "Clock.h"
+#include "Formatter.h"
+#include "Metrics.h"
+#include "Record.h"
+#include "Sink.h"
+#include "ThreadQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleLogger
+{
+	class Logger;
+
+	// What the backend thread does when every queue is empty.
+	enum class IdlePolicy : uint8_t
+	{
+		// Keep polling; lowest latency, burns its core.
+		Spin,
+		// Poll for BackendOptions::spinDuration, then yield between polls.
+		SpinThenYield,
+		// Sleep up to BackendOptions::sleepInterval; a producer that asks for
+		// it (Logger::setWakeBackend) wakes it right away. On Linux the sleep
+		// is a futex wait.
+		Sleep
+	};
+
+	struct BackendOptions
+	{
+		// CPU to pin the backend thread to; -1 leaves the affinity alone.
+		int cpu = -1;
+		IdlePolicy idlePolicy = IdlePolicy::Sleep;
+		std::chrono::microseconds spinDuration{ 50 };
+		std::chrono::microseconds sleepInterval{ 100 };
+		// Records drained before the sinks get a chance to apply their flush
+		// policy; smaller batches poll sinks more often, larger ones merge
+		// fewer times.
+		size_t maxBatch = 4096;
+	};
+
+	// Owns the per-thread queues and the thread that drains them. Started on
+	// first use and stopped (after draining) when the program exits.
+	//
+	// Every producer thread writes to its own SPSC ring, so producers never
+	// share a cache line with each other. The backend sweeps all rings and
+	// always takes the oldest pending record, which keeps the output in
+	// timestamp order across threads.
+	class Backend
+	{
+	public:
+		static constexpr size_t ThreadQueueCapacity = 1 << 13;
+		// Upper bound for OverflowPolicy::Grow, in records per thread.
+		static constexpr size_t MaxThreadQueueCapacity = 1 << 17;
+		// Bytes per thread for payloads larger than Record::PayloadSize.
+		static constexpr size_t SpillArenaCapacity = 1 << 20;
+		// How long a run of suppressed repeats is held back at most (see
+		// Logger::setSuppressRepeats).
+		static constexpr uint64_t RepeatReportInterval = 5'000'000'000;  // ns
+		// Window of Metrics::recordsPerSecond and bytesPerSecond.
+		static constexpr uint64_t MetricsInterval = 1'000'000'000;  // ns
+
+		static Backend& instance();
+
+		Backend(const Backend&) = delete;
+		Backend& operator=(const Backend&) = delete;
+
+		// Hot path: reserve a slot in the calling thread's queue, fill it and
+		// publish it. When the queue is full the policy decides between
+		// waiting, growing the queue and giving up; nullptr means the record
+		// has to be dropped.
+		Record* acquire(OverflowPolicy policy)
+		{
+			if (m_Closed.load(std::memory_order_relaxed)) [[unlikely]]
+				return nullptr;
+
+			ThreadQueue* queue = detail::t_ThreadQueue;
+			if (!queue) [[unlikely]]
+				queue = registerThread();
+
+			Record* record = queue->tryAcquire();
+			if (!record) [[unlikely]]
+				record = acquireFull(*queue, policy);
+			return record;
+		}
+
+		void publish() { detail::t_ThreadQueue->publish(); }
+
+		// Wakes the backend thread if it sleeps (IdlePolicy::Sleep), so that
+		// records published before the call are picked up right away. Costs a
+		// fence and a load when it is awake.
+		void wakeup()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_Sleeping.load(std::memory_order_relaxed)) [[unlikely]]
+				wake();
+		}
+
+		// Applied by the backend thread from its next round on; can be called
+		// at any time. Returns false if the thread couldn't be pinned to
+		// options.cpu, in which case everything else still applies.
+		bool configure(const BackendOptions& options);
+		BackendOptions options() const;
+
+		// Room for a payload that doesn't fit in a record, from the calling
+		// thread's arena. Only valid between acquire() and publish(). When the
+		// arena is full, Block waits for the backend to release space and the
+		// other policies get nullptr.
+		char* allocateSpill(size_t size, uint64_t& end, OverflowPolicy policy)
+		{
+			ThreadQueue* queue = detail::t_ThreadQueue;
+			if (!queue->spill) [[unlikely]]
+				queue->spill = std::make_unique<SpillArena>(SpillArenaCapacity);
+
+			char* data = queue->spill->allocate(size, end);
+			while (!data && policy == OverflowPolicy::Block && size <= SpillArenaCapacity) [[unlikely]]
+			{
+				std::this_thread::yield();
+				data = queue->spill->allocate(size, end);
+			}
+			return data;
+		}
+
+		// Names the calling thread in the records it queues from now on
+		// (LogEvent::threadName, %N in patterns). The name travels through the
+		// thread's queue like a record, so it costs nothing per statement;
+		// longer names are cut to Record::PayloadSize bytes.
+		void setThreadName(std::string_view name);
+
+		// Blocks until every record queued before the call has been written
+		// and the sinks have been flushed.
+		void flush();
+		// Gives up after timeout; returns false if it did.
+		bool flush(std::chrono::nanoseconds timeout);
+
+		void stop();
+
+		// Crash handling (see CrashHandler.h); both are async-signal-safe.
+		//
+		// drainForCrash() stops taking records (further statements count as
+		// dropped), has the backend thread write out everything queued and
+		// flush the sinks, and waits up to timeout for that. Returns false if
+		// it didn't finish, or if called on the backend thread itself.
+		bool drainForCrash(std::chrono::nanoseconds timeout);
+
+		// Calls visit with every record that is still queued, without
+		// consuming it. Only meant for after a failed drainForCrash(): the
+		// backend thread may still be running.
+		template <typename Visit>
+		void forEachPendingRecord(Visit&& visit) const
+		{
+			for (const ThreadQueue* queue : m_Queues)
+				queue->forEachPending(visit);
+		}
+
+		// Lock-free from any thread; see Metrics.h.
+		Metrics metrics() const { return m_Metrics.snapshot(); }
+
+		// nullptr until instance() was first called; async-signal-safe.
+		static Backend* existing();
+
+	private:
+		Backend();
+		~Backend();
+
+		ThreadQueue* registerThread();
+		Record* acquireFull(ThreadQueue& queue, OverflowPolicy policy);
+		void adoptNewQueues();
+		void releaseAbandonedQueues();
+		void idle(uint64_t& idleSince);
+		bool hasPendingRecords();
+		void wake();
+
+		void run();
+		// Returns the number of records processed.
+		size_t drain();
+		// queue is the one the record came from; it identifies the thread.
+		void process(Record& record, ThreadQueue& queue);
+		void dispatch(const Logger& logger, LogEvent& event);
+		// Reported as if logged along with next.
+		void reportDropped(const Logger& logger, const LogEvent& next);
+		// Writes out the records the logger held back, before trigger.
+		void writeBacktrace(const Logger& logger, const LogEvent& trigger);
+
+		// The last record of a logger that suppresses repeats.
+		struct RepeatState
+		{
+			const Metadata* metadata = nullptr;
+			Level level = Level::Info;
+			uint32_t thread = 0;
+			std::string threadName;
+			std::string payload;
+			uint64_t repeats = 0;
+			uint64_t firstRepeatTicks = 0;
+			uint64_t lastRepeat = 0;     // wall time
+		};
+
+		// Returns true if event, stamped with ticks, repeats the logger's
+		// previous record, which is then only counted.
+		bool isRepeat(const Logger& logger, const LogEvent& event, uint64_t ticks);
+		bool repeatsExpired(const RepeatState& state, uint64_t ticks) const;
+		void reportRepeats(const Logger& logger, RepeatState& state);
+		// Reports runs older than RepeatReportInterval, so that spam which
+		// just stops still gets its count written.
+		void reportExpiredRepeats(uint64_t ticks);
+		void pollSinks();
+		void flushSinks();
+
+		// Queue depths, once per sweep.
+		void sampleQueues();
+		void sampleLag(uint64_t timestamp);
+		void recordSinkTime(uint64_t startTicks);
+		void updateRates(uint64_t ticks);
+
+		// Queues registered since the last sweep; guarded by m_NewQueuesMutex.
+		std::mutex m_NewQueuesMutex;
+		std::vector<ThreadQueue*> m_NewQueues;
+		std::atomic<bool> m_HasNewQueues{ false };
+
+		// Backend thread only.
+		std::vector<ThreadQueue*> m_Queues;
+		TickConverter m_Clock;
+		Formatter m_Formatter;
+		std::string m_Lines[LayoutCount];
+		// Sinks written since they last reported having nothing buffered.
+		// Also keeps sinks of destroyed loggers out of reach: a logger flushes
+		// the backend, and that empties this list, before it lets its sinks go.
+		std::vector<Sink*> m_DirtySinks;
+		// Emptied by every flush, which also keeps destroyed loggers out.
+		std::unordered_map<const Logger*, RepeatState> m_Repeats;
+		uint64_t m_BatchBytes = 0;
+		uint64_t m_RateTicks = 0;
+		uint64_t m_RateRecords = 0;
+		uint64_t m_RateBytes = 0;
+
+		detail::MetricCounters m_Metrics;
+
+		std::atomic<bool> m_Running{ true };
+		std::thread m_Thread;
+
+		std::atomic<uint8_t> m_IdlePolicy{ static_cast<uint8_t>(IdlePolicy::Sleep) };
+		std::atomic<int> m_Cpu{ -1 };
+		std::atomic<int64_t> m_SpinDuration{ std::chrono::nanoseconds(BackendOptions{}.spinDuration).count() };
+		std::atomic<int64_t> m_SleepInterval{ std::chrono::nanoseconds(BackendOptions{}.sleepInterval).count() };
+		std::atomic<size_t> m_MaxBatch{ BackendOptions{}.maxBatch };
+
+		// Set while the backend sleeps; read by wakeup(). m_WakeupSequence is
+		// the futex word.
+		alignas(CacheLineSize) std::atomic<bool> m_Sleeping{ false };
+		std::atomic<uint32_t> m_WakeupSequence{ 0 };
+
+		// Read by every acquire(), written once at most.
+		alignas(CacheLineSize) std::atomic<bool> m_Closed{ false };
+		enum CrashDrain : uint8_t
+		{
+			NoCrashDrain,
+			CrashDrainRequested,
+			CrashDrainDone
+		};
+		std::atomic<uint8_t> m_CrashDrain{ NoCrashDrain };
+	};
+}
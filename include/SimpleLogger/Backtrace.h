@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Level.h"
+#include "Metadata.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleLogger
+{
+	// The records a logger holds back for context (Logger::enableBacktrace):
+	// the newest ones, still in their binary form, in a ring owned by the
+	// backend thread. Nothing is formatted unless an error comes along, and
+	// once the ring is full the entries reuse their buffers, so keeping a
+	// record costs a copy of its payload.
+	class BacktraceBuffer
+	{
+	public:
+		struct Entry
+		{
+			uint64_t wallTime = 0;
+			Level level = Level::Debug;
+			const Metadata* metadata = nullptr;
+			uint32_t thread = 0;
+			std::string threadName;
+			std::string payload;
+		};
+
+		// Keeps at most capacity entries; a changed capacity starts over.
+		void push(size_t capacity, uint64_t wallTime, Level level, const Metadata* metadata,
+			uint32_t thread, std::string_view threadName, const char* payload, size_t length)
+		{
+			if (capacity != m_Entries.size())
+			{
+				m_Entries.resize(capacity);
+				clear();
+			}
+			if (capacity == 0)
+				return;
+
+			Entry& entry = m_Entries[(m_Oldest + m_Count) % capacity];
+			if (m_Count < capacity)
+				m_Count++;
+			else
+				m_Oldest = (m_Oldest + 1) % capacity;
+			entry.wallTime = wallTime;
+			entry.level = level;
+			entry.metadata = metadata;
+			entry.thread = thread;
+			entry.threadName.assign(threadName);
+			entry.payload.assign(payload, length);
+		}
+
+		bool empty() const { return m_Count == 0; }
+		size_t size() const { return m_Count; }
+
+		// Calls visit with every entry, oldest first, then empties the ring.
+		template <typename Visit>
+		void drain(Visit&& visit)
+		{
+			for (size_t i = 0; i < m_Count; i++)
+				visit(m_Entries[(m_Oldest + i) % m_Entries.size()]);
+			clear();
+		}
+
+		void clear()
+		{
+			m_Oldest = 0;
+			m_Count = 0;
+		}
+
+	private:
+		std::vector<Entry> m_Entries;
+		size_t m_Oldest = 0;
+		size_t m_Count = 0;
+	};
+}
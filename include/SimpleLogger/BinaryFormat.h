@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Arguments.h"
+#include "Format.h"
+#include "Metadata.h"
+#include "Sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Layout of the files written by BinarySink and read by simplelogger-decode,
+// and of the frames SharedMemorySink hands to the collector.
+//
+//   file    := magic entry*
+//   magic   := "SLOGBIN1"
+//   entry   := tag body
+//
+//   Format  (tag 1): id level line argCount argType[argCount] file format
+//   Logger  (tag 2): id name
+//   Record  (tag 3): formatId loggerId timeDelta payloadLength payload
+//
+// Ids and lengths are LEB128 varints, strings are a varint length followed by
+// the bytes. Each format string and logger name is defined once, before the
+// first record that uses it. timeDelta is the zigzag-encoded difference in
+// nanoseconds to the previous record (the first one is relative to zero) and
+// payload is the record's argument encoding from Arguments.h, copied as is.
+namespace SimpleLogger::BinaryFormat
+{
+	inline constexpr std::string_view Magic = "SLOGBIN1";
+
+	enum class Tag : uint8_t
+	{
+		Format = 1,
+		Logger = 2,
+		Record = 3
+	};
+
+	inline void writeVarint(std::string& out, uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<char>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<char>(value));
+	}
+
+	inline void writeString(std::string& out, std::string_view value)
+	{
+		writeVarint(out, value.size());
+		out.append(value);
+	}
+
+	inline uint64_t zigzag(int64_t value)
+	{
+		return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+	}
+
+	inline int64_t unzigzag(uint64_t value)
+	{
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	// Reads from a byte range and remembers whether it ran past the end.
+	class Reader
+	{
+	public:
+		Reader(const char* data, size_t size)
+			: m_Position(data), m_End(data + size)
+		{
+		}
+
+		bool atEnd() const { return m_Position == m_End; }
+		bool failed() const { return m_Failed; }
+
+		uint8_t byte()
+		{
+			if (m_Position == m_End)
+			{
+				m_Failed = true;
+				return 0;
+			}
+			return static_cast<uint8_t>(*m_Position++);
+		}
+
+		uint64_t varint()
+		{
+			uint64_t value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				const uint8_t b = byte();
+				value |= static_cast<uint64_t>(b & 0x7f) << shift;
+				if (!(b & 0x80))
+					return value;
+			}
+			m_Failed = true;
+			return value;
+		}
+
+		std::string_view bytes(size_t length)
+		{
+			if (static_cast<size_t>(m_End - m_Position) < length)
+			{
+				m_Failed = true;
+				m_Position = m_End;
+				return {};
+			}
+			const std::string_view result(m_Position, length);
+			m_Position += length;
+			return result;
+		}
+
+		std::string_view string() { return bytes(static_cast<size_t>(varint())); }
+
+	private:
+		const char* m_Position;
+		const char* m_End;
+		bool m_Failed = false;
+	};
+
+	// Turns LogEvents into entries, defining each format and logger the
+	// first time a record uses it. One Encoder writes one stream.
+	class Encoder
+	{
+	public:
+		// Appends the record and any definitions it needs to out.
+		void encode(const LogEvent& event, std::string& out);
+
+		// Starts a new stream: everything gets defined again.
+		void reset();
+
+	private:
+		struct FormatInfo
+		{
+			uint64_t id;
+			bool hasStaticStrings;
+		};
+
+		const FormatInfo& formatInfo(const Metadata* metadata, std::string& out);
+		uint64_t loggerId(const Logger* logger, std::string& out);
+		void appendPayload(const LogEvent& event, std::string& out);
+
+		std::string m_Payload;
+		std::unordered_map<const Metadata*, FormatInfo> m_Formats;
+		std::unordered_map<const Logger*, uint64_t> m_Loggers;
+		std::vector<std::string> m_LoggerNames;
+		uint64_t m_LastTime = 0;
+	};
+
+	// Reads the entries an Encoder wrote, checking everything it takes from
+	// the stream so that damaged input can't make formatting read past it.
+	class Decoder
+	{
+	public:
+		// metadata and logger stay valid until reset(); payload points
+		// into the input.
+		struct Record
+		{
+			uint64_t wallTime;
+			const Metadata* metadata;
+			std::string_view logger;
+			std::string_view payload;
+		};
+
+		enum class Result : uint8_t
+		{
+			Definition,
+			Record,
+			Corrupt
+		};
+
+		// Reads one entry. On Corrupt, corruptEntry() names the kind of
+		// entry that was damaged and the stream can't be read further.
+		Result read(Reader& reader, Record& record);
+		const char* corruptEntry() const { return m_CorruptEntry; }
+
+		void reset();
+
+	private:
+		struct FormatEntry
+		{
+			std::string file;
+			std::string format;
+			std::vector<ArgType> argTypes;
+			Metadata metadata{};
+		};
+
+		Result corrupt(const char* entry);
+		static bool validFormat(const FormatEntry& entry);
+		static bool validPayload(const FormatEntry& entry, std::string_view payload);
+
+		// A deque keeps the metadata pointers stable as entries are added.
+		std::deque<FormatEntry> m_Formats;
+		std::vector<std::string> m_Loggers;
+		uint64_t m_Time = 0;
+		const char* m_CorruptEntry = nullptr;
+	};
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "BinaryFormat.h"
+#include "FileSink.h"
+
+#include <string>
+
+namespace SimpleLogger
+{
+	// Writes records without formatting them, in the format described in
+	// BinaryFormat.h: every format string goes to the file once and records
+	// only carry its id, a timestamp delta and the packed arguments. Read the
+	// file back with the simplelogger-decode tool.
+	class BinarySink : public FileSink
+	{
+	public:
+		// Throws std::system_error if the file can't be opened. The file is
+		// always truncated: one file holds exactly one dictionary.
+		explicit BinarySink(const std::filesystem::path& path, FlushPolicy policy = {});
+
+		bool wantsText() const override { return false; }
+		void write(const LogEvent& event) override;
+
+	private:
+		BinaryFormat::Encoder m_Encoder;
+		std::string m_Entry;
+	};
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if !defined(SIMPLELOGGER_USE_STEADY_CLOCK)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define SIMPLELOGGER_TICKS_RDTSC 1
+#elif defined(__aarch64__)
+#define SIMPLELOGGER_TICKS_CNTVCT 1
+#else
+#define SIMPLELOGGER_USE_STEADY_CLOCK 1
+#endif
+#endif
+
+namespace SimpleLogger
+{
+	// Timestamp stored in every record: raw CPU ticks (rdtsc on x86,
+	// cntvct_el0 on ARM64), or steady_clock nanoseconds when built with
+	// SIMPLELOGGER_USE_STEADY_CLOCK. Only the backend turns them into wall
+	// time, through TickConverter.
+	inline uint64_t now()
+	{
+#if defined(SIMPLELOGGER_TICKS_RDTSC)
+		return __rdtsc();
+#elif defined(SIMPLELOGGER_TICKS_CNTVCT)
+		uint64_t ticks;
+		asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+		return ticks;
+#else
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	// Maps ticks to nanoseconds since the Unix epoch. The ratio is measured
+	// against steady_clock by calibrate() and re-measured every
+	// RecalibrationInterval, when the epoch offset is also taken again from
+	// system_clock, so the result follows both TSC drift and wall clock
+	// adjustments without a clock step distorting the ratio. Not thread-safe;
+	// owned by the backend thread, which calibrates it before processing its
+	// first record.
+	class TickConverter
+	{
+	public:
+		static constexpr std::chrono::milliseconds InitialCalibration{ 10 };
+		static constexpr std::chrono::seconds RecalibrationInterval{ 1 };
+
+		// Blocks for InitialCalibration.
+		void calibrate();
+
+		uint64_t toWallTime(uint64_t ticks) const
+		{
+			const int64_t elapsed = static_cast<int64_t>(ticks - m_BaseTicks);
+			return m_BaseWallTime + static_cast<uint64_t>(static_cast<double>(elapsed) * m_NanosecondsPerTick);
+		}
+
+		// Cheap unless the interval has passed.
+		void recalibrateIfDue(uint64_t ticks)
+		{
+			if (ticks - m_BaseTicks >= m_RecalibrationTicks)
+				recalibrate();
+		}
+
+		double nanosecondsPerTick() const { return m_NanosecondsPerTick; }
+
+	private:
+		struct Sample
+		{
+			uint64_t ticks;
+			uint64_t wallTime;
+			uint64_t steadyTime;
+		};
+
+		static Sample sample();
+		void recalibrate();
+
+		uint64_t m_BaseTicks = 0;
+		uint64_t m_BaseWallTime = 0;
+		uint64_t m_BaseSteadyTime = 0;
+		double m_NanosecondsPerTick = 1.0;
+		uint64_t m_RecalibrationTicks = 0;
+	};
+}
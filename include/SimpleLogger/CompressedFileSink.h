@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Compression.h"
+#include "FileSink.h"
+#include "Sink.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace SimpleLogger
+{
+	// Writes a compressed stream: lines are collected into frames (a frame
+	// ends when FlushPolicy's first limit is hit), the frames are compressed
+	// in parallel on compressionPool() and appended to the file in order.
+	// The result reads with "zstd -dc" or "lz4 -dc" even while it grows, up
+	// to the last complete frame.
+	//
+	// The backend only copies lines; it waits only while maxPendingFrames
+	// frames are still being compressed.
+	class CompressedFileSink : public Sink
+	{
+	public:
+		// Throws std::system_error if the file can't be opened or the codec
+		// wasn't built in.
+		CompressedFileSink(const std::filesystem::path& path, CompressionOptions compression,
+			FlushPolicy policy = { 1024 * 1024, 0, std::chrono::seconds(1) }, size_t maxPendingFrames = 4, bool truncate = false);
+		~CompressedFileSink() override;
+
+		CompressedFileSink(const CompressedFileSink&) = delete;
+		CompressedFileSink& operator=(const CompressedFileSink&) = delete;
+
+		void write(const LogEvent& event) override;
+		bool poll() override;
+		// Compresses the current frame and waits until every frame is written.
+		void flush() override;
+
+		uint64_t framesWritten() const;
+		// Uncompressed and compressed bytes written so far.
+		uint64_t inputBytes() const;
+		uint64_t outputBytes() const;
+
+	private:
+		// Shared with the compression tasks.
+		struct State
+		{
+			int fd = -1;
+			CompressionOptions compression;
+
+			mutable std::mutex mutex;
+			std::condition_variable done;
+			std::map<uint64_t, std::string> compressed;
+			uint64_t nextWrite = 0;
+			size_t pending = 0;
+			uint64_t frames = 0;
+			uint64_t inputBytes = 0;
+			uint64_t outputBytes = 0;
+
+			~State();
+		};
+
+		static void compress(State& state, uint64_t index, std::string& frame);
+		void submitFrame();
+
+		FlushPolicy m_Policy;
+		size_t m_MaxPendingFrames;
+		std::shared_ptr<State> m_State;
+		std::shared_ptr<TaskThread> m_Pool;
+
+		// Backend thread only.
+		std::string m_Frame;
+		size_t m_Records = 0;
+		uint64_t m_NextFrame = 0;
+		std::chrono::steady_clock::time_point m_OldestRecord;
+	};
+}
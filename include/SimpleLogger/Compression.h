@@ -0,0 +1,45 @@
+#pragma once
+
+#include "TaskThread.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace SimpleLogger
+{
+	enum class Codec : uint8_t
+	{
+		None,
+		Zstd,  // needs libzstd at build time
+		Lz4    // needs liblz4 at build time
+	};
+
+	struct CompressionOptions
+	{
+		Codec codec = Codec::None;
+		// zstd: 1 (fastest) to 19; lz4: 0 (fast) or 3 to 12 (high compression).
+		int level = 3;
+	};
+
+	// Whether the codec was built in; Codec::None always is.
+	bool codecAvailable(Codec codec);
+	// ".zst", ".lz4", or empty for Codec::None.
+	std::string_view codecExtension(Codec codec);
+
+	// Appends input as one self-contained frame. Frames appended to each other
+	// make a valid stream for the zstd and lz4 command line tools. Returns
+	// false if the codec isn't available or compression failed.
+	bool compressFrame(const CompressionOptions& options, std::string_view input, std::string& out);
+
+	// Compresses source into target, frame by frame, through a temporary file
+	// that is renamed into place once complete. source is left alone.
+	bool compressFile(const CompressionOptions& options, const std::filesystem::path& source, const std::filesystem::path& target);
+
+	// The workers that compress rotated files and streamed frames, shared by
+	// all sinks: min(4, max(1, hardware threads / 2)) threads, started on
+	// first use.
+	std::shared_ptr<TaskThread> compressionPool();
+}
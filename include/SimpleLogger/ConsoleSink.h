@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Sink.h"
+
+#include <cstdio>
+#include <string>
+
+namespace SimpleLogger
+{
+	// Writes to stdout (or stderr). Lines are collected in a buffer and handed
+	// to the C stream in one call when the backend runs out of work.
+	class ConsoleSink : public Sink
+	{
+	public:
+		enum class Stream
+		{
+			Stdout,
+			Stderr
+		};
+
+		explicit ConsoleSink(Stream stream = Stream::Stdout);
+		~ConsoleSink() override;
+
+		void write(const LogEvent& event) override;
+		void flush() override;
+
+	private:
+		static constexpr size_t FlushThreshold = 64 * 1024;
+
+		std::FILE* m_File;
+		std::string m_Buffer;
+	};
+}
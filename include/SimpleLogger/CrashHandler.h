@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+
+namespace SimpleLogger
+{
+	struct CrashHandlerOptions
+	{
+		// Where the crash report goes: what happened, a backtrace, and any
+		// records the backend couldn't write itself.
+		int fd = 2;
+		bool backtrace = true;
+		// How long a crashing thread waits for the backend thread to write
+		// out the queued records and flush the sinks.
+		std::chrono::milliseconds drainTimeout{ 1'000 };
+		// Flush when the program exits normally, for at most this long; zero
+		// disables it. If the sinks don't finish in time, the process ends
+		// with EXIT_FAILURE rather than hanging on its way out.
+		std::chrono::milliseconds exitFlushTimeout{ 2'000 };
+	};
+
+	// Installs handlers for SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT and a
+	// std::terminate handler. On a crash the handler stops producers, lets
+	// the backend drain the queues (or, if the backend doesn't answer within
+	// drainTimeout, writes what is left in the rings to fd itself, with
+	// write(2) only), writes a backtrace and then re-raises the signal, so
+	// core dumps and exit statuses are unchanged.
+	//
+	// Call it once, early in main(). Registry loggers are covered by the exit
+	// flush; a static Logger constructed after this call is destroyed before
+	// it and flushes, without a bound, in its own destructor. The alternate
+	// signal stack that lets a stack overflow be reported is only set up for
+	// the calling thread.
+	void installCrashHandler(CrashHandlerOptions options = {});
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace SimpleLogger::detail
+{
+	// "00".."99", so that two decimal digits cost one table load instead of a
+	// division and a modulo each.
+	inline constexpr char DigitPairs[201] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	// value must be below 100.
+	inline void writeTwoDigits(char* out, uint32_t value)
+	{
+		std::memcpy(out, &DigitPairs[value * 2], 2);
+	}
+
+	// Number of decimal digits in value; 1 for zero.
+	inline uint32_t decimalLength(uint64_t value)
+	{
+		uint32_t length = 1;
+		for (;;)
+		{
+			if (value < 10)
+				return length;
+			if (value < 100)
+				return length + 1;
+			if (value < 1000)
+				return length + 2;
+			if (value < 10000)
+				return length + 3;
+			value /= 10000;
+			length += 4;
+		}
+	}
+
+	// Writes value in decimal at out, two digits per step from the end, and
+	// returns the end. out needs room for 20 characters.
+	inline char* writeDecimal(char* out, uint64_t value)
+	{
+		char* const end = out + decimalLength(value);
+		char* p = end;
+		while (value >= 100)
+		{
+			p -= 2;
+			writeTwoDigits(p, static_cast<uint32_t>(value % 100));
+			value /= 100;
+		}
+		if (value >= 10)
+			writeTwoDigits(p - 2, static_cast<uint32_t>(value));
+		else
+			p[-1] = static_cast<char>('0' + value);
+		return end;
+	}
+
+	// Writes value in base 2^Bits (binary, octal or hex) and returns the end.
+	// The length comes from the highest set bit, so there is no loop to find
+	// it. out needs room for 64 characters.
+	template <unsigned Bits>
+	inline char* writePowerOfTwo(char* out, uint64_t value, bool upper = false)
+	{
+		const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+		const unsigned significant = 64 - static_cast<unsigned>(std::countl_zero(value | 1));
+		char* const end = out + (significant + Bits - 1) / Bits;
+		char* p = end;
+		do
+		{
+			*--p = digits[value & ((1u << Bits) - 1)];
+			value >>= Bits;
+		} while (p != out);
+		return end;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace SimpleLogger
+{
+	// Escaping of untrusted strings. The scans find the next byte that needs
+	// attention 16 (SSE2, NEON) or 32 (AVX2) bytes at a time, so clean runs
+	// are copied with one append; the kernel is picked from CPUID on first
+	// use.
+	namespace Escape
+	{
+		enum class Kernel
+		{
+			Scalar,
+			Sse2,
+			Avx2,
+			Neon
+		};
+
+		// The kernel the scans use.
+		Kernel activeKernel();
+		const char* kernelName(Kernel kernel);
+
+		// Switches the scans to kernel; returns false (and changes nothing)
+		// if this CPU or build can't run it. For tests and benchmarks, and not
+		// safe while the backend is formatting.
+		bool useKernel(Kernel kernel);
+
+		// Index of the first byte that needs escaping inside a JSON string
+		// (a control character, '"' or '\\'), or size if there is none.
+		size_t findJsonSpecial(const char* data, size_t size);
+
+		// Index of the first byte that forces a logfmt value to be quoted:
+		// one findJsonSpecial stops at, a space or '='.
+		size_t findLogfmtSpecial(const char* data, size_t size);
+
+		// Index of the first control character other than tab, which could
+		// break a text line apart or drive the terminal.
+		size_t findTextSpecial(const char* data, size_t size);
+
+		// Appends value with JSON string escapes, without the quotes.
+		void appendJson(std::string_view value, std::string& out);
+
+		// Appends value bare if it can be, else quoted and escaped as in JSON.
+		void appendLogfmt(std::string_view value, std::string& out);
+
+		// Appends value with control characters (other than tab) escaped as
+		// in JSON, so that it stays on one line.
+		void appendText(std::string_view value, std::string& out);
+	}
+}
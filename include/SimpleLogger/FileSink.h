@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Sink.h"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+
+namespace SimpleLogger
+{
+	// When FileSink hands its buffer to the kernel. Whichever limit is hit
+	// first wins; a maxBytes or maxRecords of zero is disabled.
+	struct FlushPolicy
+	{
+		size_t maxBytes = 64 * 1024;
+		size_t maxRecords = 0;
+		// Zero writes the buffer at every poll, i.e. after each batch.
+		std::chrono::microseconds maxLatency{ std::chrono::milliseconds(10) };
+	};
+
+	// Appends lines to a file through an owned, page-aligned buffer, so that a
+	// busy logger costs one write syscall per FlushPolicy::maxBytes instead
+	// of one per line. A line that doesn't fit is sent together with the
+	// buffer in a single writev().
+	class FileSink : public Sink
+	{
+	public:
+		// Throws std::system_error if the file can't be opened.
+		explicit FileSink(const std::filesystem::path& path, FlushPolicy policy = {}, bool truncate = false);
+		~FileSink() override;
+
+		FileSink(const FileSink&) = delete;
+		FileSink& operator=(const FileSink&) = delete;
+
+		void write(const LogEvent& event) override;
+		bool poll() override;
+		void flush() override;
+
+		// Number of write syscalls issued so far.
+		size_t writeCalls() const { return m_WriteCalls; }
+
+	protected:
+		// Buffers bytes for the next write, or writes them right away together
+		// with the buffer if they don't fit.
+		void append(std::string_view bytes);
+
+		// Called right before bytes are handed to the kernel, so subclasses can
+		// switch files between two writes.
+		virtual void beforeWriteOut(size_t) {}
+
+		// Makes fd the file written to and returns the previous one, which the
+		// caller now owns.
+		int swapFile(int fd);
+
+	private:
+		void writeOut(std::string_view extra = {});
+
+		int m_Fd = -1;
+		FlushPolicy m_Policy;
+
+		char* m_Buffer = nullptr;
+		size_t m_Capacity = 0;
+		size_t m_Size = 0;
+		size_t m_Records = 0;
+		std::chrono::steady_clock::time_point m_OldestRecord;
+		size_t m_WriteCalls = 0;
+	};
+}
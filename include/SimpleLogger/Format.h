@@ -0,0 +1,233 @@
+#pragma once
+
+#include "Arguments.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace SimpleLogger
+{
+	// Format strings use "{}" as the placeholder for the next argument and
+	// "{{" / "}}" for literal braces. A placeholder may carry a spec after a
+	// colon, a subset of std::format's:
+	//
+	//   {:[[fill]align][#][0][width][.precision][type]}
+	//
+	//   align      '<' left, '>' right, '^' centre; numbers default to right,
+	//              everything else to left
+	//   #          0x / 0b / 0 prefix for hex, binary and octal
+	//   0          pad numbers with zeros after the sign and prefix
+	//   precision  digits for f/e/g (floating point only)
+	//   type       d x X o b for integers (x X also for pointers),
+	//              f F e E g G for floating point, c for chars, s for strings,
+	//              bools and chars
+	//
+	// Format strings are checked while compiling the call site, including
+	// that each spec suits its argument's type; a mismatch calls one of the
+	// functions below, which are deliberately not constexpr so that their
+	// name shows up in the error.
+	struct FormatSpec
+	{
+		char fill = ' ';
+		char align = 0;       // 0 for the type's default
+		bool alternate = false;
+		bool zeroPad = false;
+		uint16_t width = 0;
+		int16_t precision = -1;
+		char type = 0;        // 0 for the type's default
+	};
+
+	// Parses the text between ':' and '}'; returns false if it isn't a valid
+	// spec. Also used by the formatter at run time.
+	constexpr bool parseFormatSpec(std::string_view text, FormatSpec& spec)
+	{
+		auto isAlign = [](char c) { return c == '<' || c == '>' || c == '^'; };
+		auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+		size_t i = 0;
+		if (text.size() >= 2 && isAlign(text[1]) && text[0] != '{' && text[0] != '}')
+		{
+			spec.fill = text[0];
+			spec.align = text[1];
+			i = 2;
+		}
+		else if (!text.empty() && isAlign(text[0]))
+		{
+			spec.align = text[0];
+			i = 1;
+		}
+
+		if (i < text.size() && text[i] == '#')
+			spec.alternate = true, i++;
+		if (i < text.size() && text[i] == '0')
+			spec.zeroPad = true, i++;
+
+		unsigned width = 0;
+		for (; i < text.size() && isDigit(text[i]); i++)
+		{
+			width = width * 10 + static_cast<unsigned>(text[i] - '0');
+			if (width > 255)
+				return false;
+		}
+		spec.width = static_cast<uint16_t>(width);
+
+		if (i < text.size() && text[i] == '.')
+		{
+			i++;
+			if (i == text.size() || !isDigit(text[i]))
+				return false;
+			unsigned precision = 0;
+			for (; i < text.size() && isDigit(text[i]); i++)
+			{
+				precision = precision * 10 + static_cast<unsigned>(text[i] - '0');
+				if (precision > 64)
+					return false;
+			}
+			spec.precision = static_cast<int16_t>(precision);
+		}
+
+		if (i < text.size())
+		{
+			const std::string_view types = "dxXobfFeEgGcs";
+			if (types.find(text[i]) == std::string_view::npos)
+				return false;
+			spec.type = text[i++];
+		}
+		return i == text.size();
+	}
+
+	// Whether spec can format an argument of the given type.
+	constexpr bool formatSpecSuits(const FormatSpec& spec, ArgType type)
+	{
+		const bool integer = type == ArgType::Int32 || type == ArgType::Int64 || type == ArgType::UInt32 || type == ArgType::UInt64;
+		const bool floating = type == ArgType::Float || type == ArgType::Double;
+		const bool pointer = type == ArgType::Pointer;
+		const bool numeric = integer || floating || pointer;
+
+		if (spec.zeroPad && !numeric)
+			return false;
+		if (spec.precision >= 0 && !floating)
+			return false;
+		if (spec.alternate && !integer && !pointer)
+			return false;
+
+		switch (spec.type)
+		{
+		case 0:
+			return true;
+		case 'd':
+		case 'o':
+		case 'b':
+			return integer;
+		case 'x':
+		case 'X':
+			return integer || pointer;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+			return floating;
+		case 'c':
+			return type == ArgType::Char;
+		case 's':
+			return type == ArgType::String || type == ArgType::StaticString || type == ArgType::Bool || type == ArgType::Char;
+		default:
+			return false;
+		}
+	}
+
+	namespace detail
+	{
+		void formatStringHasUnmatchedBrace();
+		void formatStringHasTooFewPlaceholders();
+		void formatStringHasTooManyPlaceholders();
+		void formatStringHasInvalidSpec();
+		void formatSpecDoesNotSuitArgument();
+
+		enum class FormatError : uint8_t
+		{
+			None,
+			UnmatchedBrace,
+			InvalidSpec,
+			SpecDoesNotSuitArgument
+		};
+
+		// Counts the placeholders into count and checks each spec against
+		// the type of the argument it formats; types holds argCount entries.
+		constexpr FormatError scanFormat(std::string_view format, const ArgType* types, size_t argCount, size_t& count)
+		{
+			count = 0;
+			for (size_t i = 0; i < format.size(); i++)
+			{
+				if (format[i] == '{')
+				{
+					if (i + 1 < format.size() && format[i + 1] == '{')
+						i++;
+					else if (i + 1 < format.size() && format[i + 1] == '}')
+						count++, i++;
+					else if (i + 1 < format.size() && format[i + 1] == ':')
+					{
+						const size_t close = format.find('}', i + 2);
+						if (close == std::string_view::npos)
+							return FormatError::UnmatchedBrace;
+
+						FormatSpec spec;
+						if (!parseFormatSpec(format.substr(i + 2, close - i - 2), spec))
+							return FormatError::InvalidSpec;
+						if (types && count < argCount && !formatSpecSuits(spec, types[count]))
+							return FormatError::SpecDoesNotSuitArgument;
+						count++;
+						i = close;
+					}
+					else
+						return FormatError::UnmatchedBrace;
+				}
+				else if (format[i] == '}')
+				{
+					if (i + 1 < format.size() && format[i + 1] == '}')
+						i++;
+					else
+						return FormatError::UnmatchedBrace;
+				}
+			}
+			return FormatError::None;
+		}
+
+		constexpr size_t countPlaceholders(std::string_view format, const ArgType* types = nullptr, size_t argCount = 0)
+		{
+			size_t count = 0;
+			switch (scanFormat(format, types, argCount, count))
+			{
+			case FormatError::None:                    break;
+			case FormatError::UnmatchedBrace:          formatStringHasUnmatchedBrace(); break;
+			case FormatError::InvalidSpec:             formatStringHasInvalidSpec(); break;
+			case FormatError::SpecDoesNotSuitArgument: formatSpecDoesNotSuitArgument(); break;
+			}
+			return count;
+		}
+
+		// types lists the positional arguments first, as ArgTypesOf does.
+		template <size_t ArgCount>
+		constexpr bool checkFormat(std::string_view format, const ArgType* types = nullptr)
+		{
+			const size_t placeholders = countPlaceholders(format, types, ArgCount);
+			if (placeholders < ArgCount)
+				formatStringHasTooFewPlaceholders();
+			if (placeholders > ArgCount)
+				formatStringHasTooManyPlaceholders();
+			return true;
+		}
+	}
+
+	// The compile-time check at run time, for formats read from outside the
+	// program: whether format formats exactly the first positional entries of
+	// types. Never throws.
+	constexpr bool validFormat(std::string_view format, const ArgType* types, size_t positional)
+	{
+		size_t count = 0;
+		return detail::scanFormat(format, types, positional, count) == detail::FormatError::None && count == positional;
+	}
+}
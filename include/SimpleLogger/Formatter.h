@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Arguments.h"
+#include "Format.h"
+#include "Layout.h"
+#include "Level.h"
+#include "Metadata.h"
+#include "Pattern.h"
+#include "TimestampFormatter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace SimpleLogger
+{
+	// Turns a record into one line of text ending in '\n'. Runs on the backend
+	// thread only.
+	class Formatter
+	{
+	public:
+		// wallTime is in nanoseconds since the epoch; payload holds the
+		// arguments described by metadata.
+		void format(uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out);
+		void formatJson(uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out);
+		void formatLogfmt(uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out);
+
+		// thread and threadName describe the thread that logged, for %t and %N.
+		void formatPattern(const Pattern& pattern, uint64_t wallTime, Level level, std::string_view loggerName, uint32_t thread,
+			std::string_view threadName, const Metadata& metadata, const char* payload, std::string& out);
+
+		// Layout::Pattern without a pattern at hand is formatted as Text.
+		void format(Layout layout, uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out);
+
+		// Substitutes the positional arguments into format, leaving types and
+		// payload at the first field. With sanitize, control characters in
+		// string arguments are escaped so that the message stays on one line.
+		static void formatMessage(std::string_view format, const ArgType*& types, const char*& payload, bool sanitize, std::string& out);
+		static void appendArgument(const ArgValue& value, std::string& out);
+		// spec has been validated against the argument's type at compile time.
+		static void appendArgument(const ArgValue& value, const FormatSpec& spec, bool sanitize, std::string& out);
+
+	private:
+		void appendTimestamp(uint64_t wallTime, std::string& out);
+		std::string_view threadText(uint32_t thread);
+
+		TimestampFormatter m_Timestamp;
+		std::string m_Message;
+		// Digits of the last thread id written; ids mostly repeat.
+		uint32_t m_Thread = 0;
+		char m_ThreadText[10] = { '0' };
+		size_t m_ThreadLength = 1;
+	};
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleLogger
+{
+	// How a sink wants records written. Structured fields (see kv()) are
+	// appended as key=value in Text and Logfmt, and as members in Json.
+	enum class Layout : uint8_t
+	{
+		Text,   // 2024-05-01 12:00:00.000000000 [INFO] [net] message key=value
+		Json,   // {"ts":"2024-05-01T12:00:00.000000000+02:00","level":"INFO","logger":"net","msg":"message","key":value}
+		Logfmt, // ts=2024-05-01T12:00:00.000000000+02:00 level=INFO logger=net msg=message key=value
+		Pattern // whatever the sink's Pattern says (Sink::setPattern); Text without one
+	};
+
+	inline constexpr size_t LayoutCount = 4;
+}
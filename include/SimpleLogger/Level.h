@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Numeric values for SIMPLELOGGER_ACTIVE_LEVEL; they match SimpleLogger::Level.
+#define SIMPLELOGGER_LEVEL_TRACE 0
+#define SIMPLELOGGER_LEVEL_DEBUG 1
+#define SIMPLELOGGER_LEVEL_INFO 2
+#define SIMPLELOGGER_LEVEL_WARN 3
+#define SIMPLELOGGER_LEVEL_ERROR 4
+#define SIMPLELOGGER_LEVEL_CRITICAL 5
+#define SIMPLELOGGER_LEVEL_OFF 6
+
+// Statements below this level are removed at compile time: the compiler
+// sees a discarded `if constexpr` branch, so neither the arguments nor the
+// level check survive in the binary.
+#ifndef SIMPLELOGGER_ACTIVE_LEVEL
+#define SIMPLELOGGER_ACTIVE_LEVEL SIMPLELOGGER_LEVEL_TRACE
+#endif
+
+namespace SimpleLogger
+{
+	enum class Level : uint8_t
+	{
+		Trace,
+		Debug,
+		Info,
+		Warn,
+		Error,
+		Critical,
+		Off
+	};
+
+	inline constexpr Level ActiveLevel = static_cast<Level>(SIMPLELOGGER_ACTIVE_LEVEL);
+
+	constexpr bool isCompiledIn(Level level)
+	{
+		return level >= ActiveLevel && level != Level::Off;
+	}
+
+	constexpr std::string_view toString(Level level)
+	{
+		switch (level)
+		{
+		case Level::Trace:    return "TRACE";
+		case Level::Debug:    return "DEBUG";
+		case Level::Info:     return "INFO";
+		case Level::Warn:     return "WARN";
+		case Level::Error:    return "ERROR";
+		case Level::Critical: return "CRITICAL";
+		case Level::Off:      return "OFF";
+		}
+		return "UNKNOWN";
+	}
+
+	// Case-insensitive inverse of toString(); also accepts "warning".
+	constexpr std::optional<Level> parseLevel(std::string_view name)
+	{
+		auto equals = [name](std::string_view upper)
+		{
+			if (name.size() != upper.size())
+				return false;
+			for (size_t i = 0; i < name.size(); i++)
+			{
+				const char c = name[i] >= 'a' && name[i] <= 'z' ? static_cast<char>(name[i] - 'a' + 'A') : name[i];
+				if (c != upper[i])
+					return false;
+			}
+			return true;
+		};
+
+		for (uint8_t i = 0; i <= static_cast<uint8_t>(Level::Off); i++)
+		{
+			if (equals(toString(static_cast<Level>(i))))
+				return static_cast<Level>(i);
+		}
+		if (equals("WARNING"))
+			return Level::Warn;
+		return std::nullopt;
+	}
+}
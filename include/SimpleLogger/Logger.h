@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Arguments.h"
+#include "Backend.h"
+#include "Backtrace.h"
+#include "Clock.h"
+#include "Format.h"
+#include "Level.h"
+#include "Metadata.h"
+#include "Sink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleLogger
+{
+	struct SourceLocation
+	{
+		const char* format;
+		const char* file;
+		uint32_t line;
+	};
+
+	namespace detail
+	{
+		template <typename CallSite, Level L, typename... Args>
+		struct CallSiteMetadata
+		{
+			static constexpr Metadata Value{
+				CallSite::location().format,
+				CallSite::location().file,
+				CallSite::location().line,
+				L,
+				ArgTypeCount<Args...>,
+				ArgTypesOf<Args...>
+			};
+		};
+	}
+
+	// Front end of the asynchronous logger. A log statement copies its
+	// arguments into a queue slot and returns; the backend thread formats it
+	// and writes it to the sinks later. The logger flushes the backend when it
+	// is destroyed, so queued records never outlive it.
+	//
+	// Besides the compile-time threshold every logger has a runtime level
+	// that can be changed while the program runs (see Registry.h).
+	class Logger
+	{
+	public:
+		Logger(std::string name, std::vector<std::shared_ptr<Sink>> sinks, Level level = Level::Info);
+		~Logger();
+
+		Logger(const Logger&) = delete;
+		Logger& operator=(const Logger&) = delete;
+
+		// Logs an already formatted message.
+		void log(Level level, std::string_view message);
+
+		// Used by the LOG_* macros. CallSite provides the format string and
+		// source location as constants, so the metadata is built at compile
+		// time and the hot path only copies the arguments.
+		template <typename CallSite, Level L, typename... Args>
+		void logStatement([[maybe_unused]] Args&&... args)
+		{
+			static_assert((detail::Loggable<Args> && ...), "SimpleLogger: unsupported argument type");
+			static_assert(FieldsFollowPositional<Args...>, "SimpleLogger: kv() fields must come after the positional arguments");
+			static_assert(detail::checkFormat<PositionalCount<Args...>>(CallSite::location().format, ArgTypesOf<detail::ArgDecay<Args>...>));
+
+			if constexpr (isCompiledIn(L))
+			{
+				if (!shouldLog(L))
+					return;
+				enqueue(L, &detail::CallSiteMetadata<CallSite, L, detail::ArgDecay<Args>...>::Value, args...);
+			}
+		}
+
+		// One relaxed load. The level sits on its own cache line, so the check
+		// never shares a line with anything producers write to. With a
+		// backtrace enabled it also passes statements that are only kept for
+		// the backtrace.
+		bool shouldLog(Level level) const
+		{
+			return static_cast<uint8_t>(level) >= m_QueueLevel.load(std::memory_order_relaxed);
+		}
+
+		Level level() const { return static_cast<Level>(m_Level.load(std::memory_order_relaxed)); }
+		void setLevel(Level level)
+		{
+			m_Level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+			updateQueueLevel();
+		}
+
+		// Keeps the last `records` statements from `level` up to the logger's
+		// own level in memory, unformatted, and writes them to the sinks only
+		// when a record at BacktraceTrigger or above arrives, right before it.
+		// Zero records turns it off; changing the size or turning it off drops
+		// what is held at that point.
+		static constexpr Level BacktraceTrigger = Level::Error;
+		void enableBacktrace(size_t records, Level level = Level::Trace)
+		{
+			m_BacktraceRecords.store(records, std::memory_order_relaxed);
+			m_BacktraceLevel.store(static_cast<uint8_t>(records ? level : Level::Off), std::memory_order_relaxed);
+			updateQueueLevel();
+		}
+		size_t backtraceRecords() const { return m_BacktraceRecords.load(std::memory_order_relaxed); }
+
+		// Only consulted when the calling thread's queue is full.
+		OverflowPolicy overflowPolicy() const { return static_cast<OverflowPolicy>(m_OverflowPolicy.load(std::memory_order_relaxed)); }
+		void setOverflowPolicy(OverflowPolicy policy) { m_OverflowPolicy.store(static_cast<uint8_t>(policy), std::memory_order_relaxed); }
+
+		// When set, every statement wakes the backend thread if it sleeps
+		// (IdlePolicy::Sleep), so the record doesn't wait out the sleep
+		// interval. Costs a fence per statement.
+		bool wakesBackend() const { return m_WakeBackend.load(std::memory_order_relaxed); }
+		void setWakeBackend(bool wake) { m_WakeBackend.store(wake, std::memory_order_relaxed); }
+
+		// When set, the backend writes a record that repeats the previous one
+		// of this logger (same statement, same arguments) only as a count:
+		// "last message repeated N times", once a different record arrives, on
+		// flush, or Backend::RepeatReportInterval after the first repeat,
+		// whether or not the repeats go on.
+		bool suppressRepeats() const { return m_SuppressRepeats.load(std::memory_order_relaxed); }
+		void setSuppressRepeats(bool suppress) { m_SuppressRepeats.store(suppress, std::memory_order_relaxed); }
+
+		// Records lost to a full queue since the backend last reported them.
+		uint64_t droppedRecords() const { return m_Dropped.load(std::memory_order_relaxed); }
+		uint64_t takeDroppedRecords() const { return m_Dropped.exchange(0, std::memory_order_relaxed); }
+
+		const std::string& name() const { return m_Name; }
+		const std::vector<std::shared_ptr<Sink>>& sinks() const { return m_Sinks; }
+
+	private:
+		// Arguments that don't fit in the record go to the thread's spill
+		// arena. If that is full (and the policy doesn't wait), strings are
+		// truncated to fit the record, and a record whose fixed-size arguments
+		// alone don't fit is dropped.
+		//
+		// Args are forwarding references only so that their declared types
+		// (literal or not) survive; nothing is moved from.
+		template <typename... Args>
+		void enqueue(Level level, const Metadata* metadata, Args&&... args)
+		{
+			Backend& backend = Backend::instance();
+			Record* record = backend.acquire(overflowPolicy());
+			if (!record) [[unlikely]]
+			{
+				countDropped();
+				return;
+			}
+
+			record->timestamp = now();
+			record->logger = this;
+			record->metadata = metadata;
+			record->kind = RecordKind::Log;
+			record->level = level;
+			record->flags = static_cast<uint8_t>(level) < m_Level.load(std::memory_order_relaxed) ? RecordBacktrace : 0;
+
+			if constexpr (HasVariableSize<Args...> || FixedEncodedSize<Args...> > Record::PayloadSize)
+			{
+				const size_t size = encodedSize(args...);
+				if (size > Record::PayloadSize) [[unlikely]]
+				{
+					SpillReference spill;
+					if (char* data = backend.allocateSpill(size, spill.end, overflowPolicy()))
+					{
+						spill.data = data;
+						encodeArguments(data, size, args...);
+						std::memcpy(record->payload, &spill, sizeof(spill));
+						record->length = static_cast<uint32_t>(size);
+						record->flags |= RecordSpilled;
+						publish(backend);
+						return;
+					}
+
+					if constexpr (FixedEncodedSize<Args...> > Record::PayloadSize)
+					{
+						// The slot was never published, so it is simply reused.
+						countDropped();
+						return;
+					}
+				}
+			}
+
+			if constexpr (FixedEncodedSize<Args...> <= Record::PayloadSize)
+			{
+				record->length = static_cast<uint32_t>(encodeArguments(record->payload, Record::PayloadSize, args...));
+				publish(backend);
+			}
+		}
+
+		friend class Backend;
+
+		void countDropped() { m_Dropped.fetch_add(1, std::memory_order_relaxed); }
+
+		void publish(Backend& backend)
+		{
+			backend.publish();
+			if (m_WakeBackend.load(std::memory_order_relaxed)) [[unlikely]]
+				backend.wakeup();
+		}
+
+		void updateQueueLevel()
+		{
+			m_QueueLevel.store(std::min(m_Level.load(std::memory_order_relaxed), m_BacktraceLevel.load(std::memory_order_relaxed)),
+				std::memory_order_relaxed);
+		}
+
+		// Read on every statement, written almost never.
+		alignas(CacheLineSize) std::atomic<uint8_t> m_QueueLevel;
+		std::atomic<uint8_t> m_Level;
+		std::atomic<uint8_t> m_BacktraceLevel{ static_cast<uint8_t>(Level::Off) };
+		std::atomic<uint8_t> m_OverflowPolicy{ static_cast<uint8_t>(OverflowPolicy::Block) };
+		std::atomic<bool> m_SuppressRepeats{ false };
+		std::atomic<bool> m_WakeBackend{ false };
+		std::atomic<size_t> m_BacktraceRecords{ 0 };
+		// Only written while dropping, so it gets a line of its own.
+		alignas(CacheLineSize) mutable std::atomic<uint64_t> m_Dropped{ 0 };
+		alignas(CacheLineSize) std::string m_Name;
+		std::vector<std::shared_ptr<Sink>> m_Sinks;
+		// Backend thread only.
+		mutable BacktraceBuffer m_Backtrace;
+	};
+
+	// Logger used by the LOG_* macros: the registry's "root" logger, writing
+	// to stdout.
+	Logger& defaultLogger();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Logger.h"
+#include "RateLimit.h"
+
+#include <cstdint>
+
+// SIMPLELOGGER_LOG(logger, level, format, args...)
+//
+// Captures the arguments in binary form and queues them; formatting happens
+// on the backend thread. The format string must be a literal and is checked
+// against the argument count at compile time. Statements below
+// SIMPLELOGGER_ACTIVE_LEVEL compile to nothing, arguments included.
+#define SIMPLELOGGER_LOG(logger, level, fmt, ...)                                                          \
+	do                                                                                                     \
+	{                                                                                                      \
+		if constexpr (::SimpleLogger::isCompiledIn(level))                                                 \
+		{                                                                                                  \
+			struct SimpleLoggerCallSite                                                                    \
+			{                                                                                              \
+				static constexpr ::SimpleLogger::SourceLocation location()                                 \
+				{                                                                                          \
+					return { fmt, __FILE__, static_cast<uint32_t>(__LINE__) };                            \
+				}                                                                                          \
+			};                                                                                             \
+			(logger).template logStatement<SimpleLoggerCallSite, level>(__VA_ARGS__);                      \
+		}                                                                                                  \
+	} while (0)
+
+#define LOGGER_TRACE(logger, fmt, ...) SIMPLELOGGER_LOG(logger, ::SimpleLogger::Level::Trace, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOGGER_DEBUG(logger, fmt, ...) SIMPLELOGGER_LOG(logger, ::SimpleLogger::Level::Debug, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOGGER_INFO(logger, fmt, ...) SIMPLELOGGER_LOG(logger, ::SimpleLogger::Level::Info, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOGGER_WARN(logger, fmt, ...) SIMPLELOGGER_LOG(logger, ::SimpleLogger::Level::Warn, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOGGER_ERROR(logger, fmt, ...) SIMPLELOGGER_LOG(logger, ::SimpleLogger::Level::Error, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOGGER_CRITICAL(logger, fmt, ...) SIMPLELOGGER_LOG(logger, ::SimpleLogger::Level::Critical, fmt __VA_OPT__(,) __VA_ARGS__)
+
+// Same as above, on SimpleLogger::defaultLogger().
+#define LOG_TRACE(fmt, ...) LOGGER_TRACE(::SimpleLogger::defaultLogger(), fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOGGER_DEBUG(::SimpleLogger::defaultLogger(), fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_INFO(fmt, ...) LOGGER_INFO(::SimpleLogger::defaultLogger(), fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_WARN(fmt, ...) LOGGER_WARN(::SimpleLogger::defaultLogger(), fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOGGER_ERROR(::SimpleLogger::defaultLogger(), fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_CRITICAL(fmt, ...) LOGGER_CRITICAL(::SimpleLogger::defaultLogger(), fmt __VA_OPT__(,) __VA_ARGS__)
+
+// SIMPLELOGGER_LOG_LIMITED(logger, level, limiter, format, args...)
+//
+// Like SIMPLELOGGER_LOG, but only when the call site's own limiter (one of
+// the classes in RateLimit.h) lets the statement through. The limiter is
+// asked after the level check, so filtered statements don't count.
+#define SIMPLELOGGER_LOG_LIMITED(logger, level, limiter, fmt, ...)                                         \
+	do                                                                                                     \
+	{                                                                                                      \
+		if constexpr (::SimpleLogger::isCompiledIn(level))                                                 \
+		{                                                                                                  \
+			static limiter simpleLoggerLimiter;                                                            \
+			if ((logger).shouldLog(level) && simpleLoggerLimiter.allow())                                  \
+				SIMPLELOGGER_LOG(logger, level, fmt __VA_OPT__(,) __VA_ARGS__);                            \
+		}                                                                                                  \
+	} while (0)
+
+// Rate limited statements; n and ms must be constants.
+//   LOGGER_EVERY_N(logger, Level::Warn, 1000, "queue full")  1st, 1001st, ... call
+//   LOGGER_FIRST_N(logger, Level::Info, 10, "cache miss")    the first 10 calls
+//   LOGGER_EVERY_MS(logger, Level::Error, 500, "no route")   at most one per 500 ms
+#define LOGGER_EVERY_N(logger, level, n, fmt, ...) SIMPLELOGGER_LOG_LIMITED(logger, level, ::SimpleLogger::EveryN<(n)>, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOGGER_FIRST_N(logger, level, n, fmt, ...) SIMPLELOGGER_LOG_LIMITED(logger, level, ::SimpleLogger::FirstN<(n)>, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOGGER_EVERY_MS(logger, level, ms, fmt, ...) SIMPLELOGGER_LOG_LIMITED(logger, level, ::SimpleLogger::EveryInterval<(ms)>, fmt __VA_OPT__(,) __VA_ARGS__)
+
+#define LOG_EVERY_N(level, n, fmt, ...) LOGGER_EVERY_N(::SimpleLogger::defaultLogger(), level, n, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_FIRST_N(level, n, fmt, ...) LOGGER_FIRST_N(::SimpleLogger::defaultLogger(), level, n, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_EVERY_MS(level, ms, fmt, ...) LOGGER_EVERY_MS(::SimpleLogger::defaultLogger(), level, ms, fmt __VA_OPT__(,) __VA_ARGS__)
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Arguments.h"
+#include "Level.h"
+
+#include <cstdint>
+
+namespace SimpleLogger
+{
+	// Everything about a log statement that is known at compile time. One
+	// instance lives in static storage per call site and records only carry
+	// a pointer to it.
+	struct Metadata
+	{
+		const char* format;
+		const char* file;
+		uint32_t line;
+		Level level;
+		uint8_t argCount;
+		const ArgType* argTypes;
+	};
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace SimpleLogger
+{
+	// Upper bounds of the flush latency buckets: 1 µs, 4 µs, 16 µs and so on
+	// up to about a second. The last bucket counts everything slower.
+	constexpr size_t FlushLatencyBuckets = 12;
+	constexpr uint64_t flushLatencyBound(size_t bucket)  // ns
+	{
+		uint64_t bound = 1'000;
+		for (size_t i = 0; i < bucket; i++)
+			bound *= 4;
+		return bound;
+	}
+
+	// What the backend reports about itself (Backend::metrics()). Counters
+	// count from the start of the process; rates cover the last
+	// MetricsInterval.
+	struct Metrics
+	{
+		uint64_t records = 0;           // log records taken off the queues
+		uint64_t bytes = 0;             // handed to sinks: line bytes, or payload bytes for binary sinks
+		uint64_t dropped = 0;           // lost to full queues, counted when reported
+		uint64_t recordsPerSecond = 0;
+		uint64_t bytesPerSecond = 0;
+
+		uint64_t queueDepth = 0;        // records pending in all thread queues, at the last sweep
+		uint64_t queueHighWater = 0;    // most records ever seen pending in one thread's queue
+
+		// Produce-to-write lag of the oldest record at the start of a batch.
+		uint64_t lag = 0;               // ns, last batch
+		uint64_t maxLag = 0;            // ns
+
+		// Time spent in the sinks' poll() or flush() per backend round that
+		// had any sink to poll.
+		std::array<uint64_t, FlushLatencyBuckets> flushLatency{};
+		uint64_t flushLatencySum = 0;   // ns
+		uint64_t flushes = 0;
+	};
+
+	// Metrics in the Prometheus text exposition format, as
+	// "<prefix>_records_total" and so on.
+	std::string formatPrometheus(const Metrics& metrics, std::string_view prefix = "simplelogger");
+
+	namespace detail
+	{
+		// The backend's live counters. Only the backend thread writes them,
+		// so an update is a relaxed load and store rather than a locked RMW,
+		// and readers on any thread load them without locks. A snapshot is
+		// consistent per field, not across fields.
+		struct MetricCounters
+		{
+			static void add(std::atomic<uint64_t>& counter, uint64_t value)
+			{
+				counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+			}
+
+			static void raise(std::atomic<uint64_t>& counter, uint64_t value)
+			{
+				if (value > counter.load(std::memory_order_relaxed))
+					counter.store(value, std::memory_order_relaxed);
+			}
+
+			Metrics snapshot() const;
+
+			std::atomic<uint64_t> records{ 0 };
+			std::atomic<uint64_t> bytes{ 0 };
+			std::atomic<uint64_t> dropped{ 0 };
+			std::atomic<uint64_t> recordsPerSecond{ 0 };
+			std::atomic<uint64_t> bytesPerSecond{ 0 };
+			std::atomic<uint64_t> queueDepth{ 0 };
+			std::atomic<uint64_t> queueHighWater{ 0 };
+			std::atomic<uint64_t> lag{ 0 };
+			std::atomic<uint64_t> maxLag{ 0 };
+			std::atomic<uint64_t> flushLatency[FlushLatencyBuckets] = {};
+			std::atomic<uint64_t> flushLatencySum{ 0 };
+			std::atomic<uint64_t> flushes{ 0 };
+		};
+	}
+}
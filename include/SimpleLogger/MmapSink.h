@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Sink.h"
+
+#include <cstddef>
+#include <filesystem>
+
+namespace SimpleLogger
+{
+	struct MmapSinkOptions
+	{
+		// Preallocated size of every segment file.
+		size_t segmentSize = 64 * 1024 * 1024;
+		// msync(MS_ASYNC) on flush(), to start writeback early. The data
+		// survives a crash of the process either way.
+		bool syncOnFlush = false;
+	};
+
+	// Writes lines by copying them into a shared mapping of a preallocated
+	// segment file, so the steady state issues no write syscalls at all.
+	// Segments are named "<stem>.<n><extension>" next to path, numbered after
+	// any that already exist. The next segment is prepared once the current
+	// one is three quarters full. A line that doesn't fit in what is left
+	// starts the next segment, and the full one is truncated to the bytes used
+	// and closed; only lines longer than a segment are split. If the space
+	// can't be allocated up front (posix_fallocate), there is no segment and
+	// lines are dropped until one can be created.
+	//
+	// Because the mapping is MAP_SHARED the kernel owns the dirty pages, and
+	// they reach the file even if the process dies. After such a crash the
+	// last segment keeps its preallocated size, with zero bytes after the
+	// last line.
+	class MmapSink : public Sink
+	{
+	public:
+		// Throws std::system_error if the first segment can't be created.
+		explicit MmapSink(const std::filesystem::path& path, MmapSinkOptions options = {});
+		~MmapSink() override;
+
+		MmapSink(const MmapSink&) = delete;
+		MmapSink& operator=(const MmapSink&) = delete;
+
+		void write(const LogEvent& event) override;
+		bool poll() override;
+		void flush() override;
+
+		const std::filesystem::path& currentSegment() const { return m_Current.path; }
+
+	private:
+		struct Segment
+		{
+			int fd = -1;
+			char* data = nullptr;
+			std::filesystem::path path;
+		};
+
+		Segment openSegment();
+		void closeSegment(Segment& segment, size_t used);
+		void advance();
+
+		std::filesystem::path m_Directory;
+		std::string m_Stem;
+		std::string m_Extension;
+		MmapSinkOptions m_Options;
+		size_t m_NextIndex = 0;
+
+		Segment m_Current;
+		size_t m_Used = 0;
+		Segment m_Next;
+	};
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Sink.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SimpleLogger
+{
+	enum class NetworkProtocol
+	{
+		Udp,  // one datagram per line, sent with sendmmsg
+		Tcp   // a stream of lines, sent in large writes
+	};
+
+	struct NetworkSinkOptions
+	{
+		// Lines waiting to be sent, in bytes. Lines beyond this are dropped
+		// and counted, so a collector outage never pushes back on the backend.
+		size_t maxOutboxBytes = 4 * 1024 * 1024;
+		// UDP only: longer lines are cut to fit one datagram.
+		size_t maxDatagramSize = 1400;
+		// Delay before reconnecting after a failure, doubled after every
+		// further failure up to maxBackoff and reset once connected.
+		std::chrono::milliseconds minBackoff{ 100 };
+		std::chrono::milliseconds maxBackoff{ 10'000 };
+		std::chrono::milliseconds connectTimeout{ 1'000 };
+		// Longest flush() waits for the outbox to drain.
+		std::chrono::milliseconds flushTimeout{ 1'000 };
+	};
+
+	// Ships lines to a collector from an I/O thread of its own. The backend
+	// only appends lines to a buffer that is handed to the I/O thread between
+	// batches; resolving, connecting and sending all happen there. Sockets
+	// are non-blocking and checked for stop every 100 ms, so a stalled
+	// connect or send holds up the destructor for at most that long; a host
+	// name lookup in progress can't be interrupted, though, and delays it
+	// for as long as getaddrinfo() waits on the resolver.
+	class NetworkSink final : public Sink
+	{
+	public:
+		NetworkSink(NetworkProtocol protocol, std::string host, uint16_t port, NetworkSinkOptions options = {});
+		~NetworkSink() override;
+
+		NetworkSink(const NetworkSink&) = delete;
+		NetworkSink& operator=(const NetworkSink&) = delete;
+
+		void write(const LogEvent& event) override;
+		bool poll() override;
+
+		// Hands buffered lines to the I/O thread and waits until they are
+		// sent, the collector is found to be down, or flushTimeout passes.
+		void flush() override;
+
+		uint64_t sentRecords() const { return m_Sent.load(std::memory_order_relaxed); }
+		uint64_t droppedRecords() const { return m_Dropped.load(std::memory_order_relaxed); }
+		uint64_t connects() const { return m_Connects.load(std::memory_order_relaxed); }
+
+	private:
+		// Lines back to back, with the end offset of each.
+		struct Outbox
+		{
+			std::string data;
+			std::vector<uint32_t> ends;
+
+			void clear()
+			{
+				data.clear();
+				ends.clear();
+			}
+		};
+
+		bool handOver(bool wait);
+		void run();
+		// I/O thread only. connect() returns false without trying while the
+		// backoff runs; failed() closes the socket and extends the backoff.
+		bool connect();
+		bool waitConnected(int fd);
+		void disconnect();
+		void failed();
+		// Send m_Sending from m_NextLine; return false if the connection
+		// failed, or stalled while stopping.
+		bool sendUdp();
+		bool sendTcp();
+		bool waitWritable();
+		void consumed(size_t bytes);
+		void dropUnsent();
+		size_t lineStart(size_t line) const { return line == 0 ? 0 : m_Sending.ends[line - 1]; }
+
+		const NetworkProtocol m_Protocol;
+		const std::string m_Host;
+		const uint16_t m_Port;
+		const NetworkSinkOptions m_Options;
+
+		// Backend thread only.
+		Outbox m_Pending;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Wakeup;
+		std::condition_variable m_Drained;
+		Outbox m_Queued;
+		bool m_Down = false;
+		std::atomic<bool> m_Stopping{ false };
+
+		// I/O thread only.
+		Outbox m_Sending;
+		size_t m_NextLine = 0;
+		size_t m_LineOffset = 0;  // TCP: bytes of m_NextLine already sent
+		int m_Socket = -1;
+		std::chrono::milliseconds m_Backoff;
+		std::chrono::steady_clock::time_point m_NextAttempt{};
+
+		std::atomic<size_t> m_OutboxBytes{ 0 };
+		std::atomic<uint64_t> m_Sent{ 0 };
+		std::atomic<uint64_t> m_Dropped{ 0 };
+		std::atomic<uint64_t> m_Connects{ 0 };
+		std::thread m_Thread;
+	};
+}
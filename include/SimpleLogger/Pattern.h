@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleLogger
+{
+	// Line layout given as a pattern, for Sink::setPattern(). Flags:
+	//
+	//   %v  message, with fields appended as in Layout::Text
+	//   %l  level name        %L  level initial
+	//   %n  logger name       %t  thread id       %N  thread name, or its id
+	//   %s  source file name  %g  source path     %#  line    %@  file:line
+	//   %Y %m %d %H %M %S     local date and time fields
+	//   %T  HH:MM:SS          %D  YYYY-MM-DD      %+  full timestamp
+	//   %e %f %F              milli-, micro- and nanoseconds
+	//   %%  a literal '%'
+	//
+	// %l, %L, %n, %t and %N take a width, "%-8l" to pad on the right and "%8l" on
+	// the left. Every line ends with '\n', which the pattern leaves out.
+	//
+	// The pattern is parsed once into a flat list of PatternOps, at compile
+	// time through makePattern<"...">(); per line the formatter only walks the
+	// list. Date and time flags are slices of the timestamp the formatter
+	// caches per second.
+	enum class PatternField : uint8_t
+	{
+		Literal,    // offset and length into the pattern text
+		Timestamp,  // offset and length into TimestampFormatter's buffer
+		Level,
+		LevelInitial,
+		Logger,
+		Thread,
+		ThreadName,
+		Message,
+		File,
+		Path,
+		Line,
+		FileLine
+	};
+
+	struct PatternOp
+	{
+		PatternField field = PatternField::Literal;
+		bool padRight = false;
+		uint8_t width = 0;
+		uint16_t offset = 0;
+		uint16_t length = 0;
+	};
+
+	namespace detail
+	{
+		enum class PatternError : uint8_t
+		{
+			None,
+			UnknownFlag,
+			TrailingPercent,
+			TooLong
+		};
+
+		// Parses pattern into ops, which needs room for pattern.size() + 1
+		// entries; count is set to the number used. Adjacent literal text,
+		// "%%" included, ends up in one op.
+		constexpr PatternError parsePattern(std::string_view pattern, PatternOp* ops, size_t& count)
+		{
+			count = 0;
+			if (pattern.size() > UINT16_MAX)
+				return PatternError::TooLong;
+
+			auto literal = [&](size_t offset)
+			{
+				PatternOp& last = ops[count != 0 ? count - 1 : 0];
+				if (count != 0 && last.field == PatternField::Literal && last.offset + last.length == offset)
+					last.length++;
+				else
+					ops[count++] = { PatternField::Literal, false, 0, static_cast<uint16_t>(offset), 1 };
+			};
+
+			for (size_t i = 0; i < pattern.size(); i++)
+			{
+				if (pattern[i] != '%')
+				{
+					literal(i);
+					continue;
+				}
+				if (++i == pattern.size())
+					return PatternError::TrailingPercent;
+				if (pattern[i] == '%')
+				{
+					// Only the second '%' is text, so the literal restarts.
+					ops[count++] = { PatternField::Literal, false, 0, static_cast<uint16_t>(i), 1 };
+					continue;
+				}
+
+				PatternOp op;
+				if (pattern[i] == '-')
+				{
+					op.padRight = true;
+					if (++i == pattern.size())
+						return PatternError::TrailingPercent;
+				}
+				uint32_t width = 0;
+				while (pattern[i] >= '0' && pattern[i] <= '9')
+				{
+					width = width * 10 + static_cast<uint32_t>(pattern[i] - '0');
+					if (width > UINT8_MAX)
+						return PatternError::UnknownFlag;
+					if (++i == pattern.size())
+						return PatternError::TrailingPercent;
+				}
+				op.width = static_cast<uint8_t>(width);
+
+				auto timestamp = [&](uint16_t offset, uint16_t length)
+				{
+					op.field = PatternField::Timestamp;
+					op.offset = offset;
+					op.length = length;
+				};
+				bool padded = false;
+				switch (pattern[i])
+				{
+				case 'v': op.field = PatternField::Message; break;
+				case 'l': op.field = PatternField::Level; padded = true; break;
+				case 'L': op.field = PatternField::LevelInitial; padded = true; break;
+				case 'n': op.field = PatternField::Logger; padded = true; break;
+				case 't': op.field = PatternField::Thread; padded = true; break;
+				case 'N': op.field = PatternField::ThreadName; padded = true; break;
+				case 's': op.field = PatternField::File; break;
+				case 'g': op.field = PatternField::Path; break;
+				case '#': op.field = PatternField::Line; break;
+				case '@': op.field = PatternField::FileLine; break;
+				// Offsets into "YYYY-MM-DD HH:MM:SS.nnnnnnnnn".
+				case 'Y': timestamp(0, 4); break;
+				case 'm': timestamp(5, 2); break;
+				case 'd': timestamp(8, 2); break;
+				case 'H': timestamp(11, 2); break;
+				case 'M': timestamp(14, 2); break;
+				case 'S': timestamp(17, 2); break;
+				case 'e': timestamp(20, 3); break;
+				case 'f': timestamp(20, 6); break;
+				case 'F': timestamp(20, 9); break;
+				case 'T': timestamp(11, 8); break;
+				case 'D': timestamp(0, 10); break;
+				case '+': timestamp(0, 29); break;
+				default:
+					return PatternError::UnknownFlag;
+				}
+				if (!padded && (op.width != 0 || op.padRight))
+					return PatternError::UnknownFlag;
+				ops[count++] = op;
+			}
+			return PatternError::None;
+		}
+
+		void patternHasUnknownFlag();
+		void patternEndsWithPercent();
+		void patternIsTooLong();
+
+		template <size_t N>
+		struct PatternString
+		{
+			constexpr PatternString(const char (&text)[N])
+			{
+				std::copy(text, text + N, this->text);
+			}
+
+			constexpr std::string_view view() const { return std::string_view(text, N - 1); }
+
+			char text[N] = {};
+		};
+
+		template <PatternString P>
+		struct CompiledPattern
+		{
+			static constexpr size_t countOps()
+			{
+				std::array<PatternOp, P.view().size() + 1> ops{};
+				size_t count = 0;
+				switch (parsePattern(P.view(), ops.data(), count))
+				{
+				case PatternError::None:            break;
+				case PatternError::UnknownFlag:     patternHasUnknownFlag(); break;
+				case PatternError::TrailingPercent: patternEndsWithPercent(); break;
+				case PatternError::TooLong:         patternIsTooLong(); break;
+				}
+				return count;
+			}
+
+			static constexpr std::array<PatternOp, countOps()> parse()
+			{
+				std::array<PatternOp, countOps()> ops{};
+				size_t count = 0;
+				parsePattern(P.view(), ops.data(), count);
+				return ops;
+			}
+
+			static constexpr std::array<PatternOp, countOps()> Ops = parse();
+		};
+	}
+
+	class Pattern
+	{
+	public:
+		// Parses pattern at run time, once. Throws std::invalid_argument if
+		// it has an unknown flag.
+		explicit Pattern(std::string_view pattern);
+
+		// The text and ops may point into the object's own buffers, and
+		// patterns are shared through shared_ptr anyway.
+		Pattern(const Pattern&) = delete;
+		Pattern& operator=(const Pattern&) = delete;
+
+		std::string_view text() const { return m_Text; }
+		std::span<const PatternOp> ops() const { return m_Ops; }
+
+		// Whether any op needs the timestamp, so lines without one skip it.
+		bool usesTimestamp() const { return m_UsesTimestamp; }
+
+		// Parsed while compiling; an unknown flag is a compile error naming
+		// one of the detail::pattern* functions.
+		template <detail::PatternString P>
+		friend std::shared_ptr<const Pattern> makePattern();
+
+	private:
+		Pattern(std::string_view text, std::span<const PatternOp> ops);
+
+		std::vector<PatternOp> m_OwnedOps;
+		std::string m_OwnedText;
+		std::string_view m_Text;
+		std::span<const PatternOp> m_Ops;
+		bool m_UsesTimestamp = false;
+	};
+
+	template <detail::PatternString P>
+	std::shared_ptr<const Pattern> makePattern()
+	{
+		return std::shared_ptr<const Pattern>(new Pattern(P.view(), detail::CompiledPattern<P>::Ops));
+	}
+}
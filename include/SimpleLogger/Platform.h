@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+namespace SimpleLogger
+{
+	// Used to keep indices written by different threads on separate lines.
+	constexpr size_t CacheLineSize = 64;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace SimpleLogger
+{
+	// Per call site state for the rate limited macros in Macros.h. Each
+	// statement owns one limiter as a function-local static, so the check is
+	// a single relaxed atomic operation and never touches the queue when it
+	// fails. Limiters are only consulted for statements the logger's level
+	// lets through.
+
+	// Lets the 1st, (N+1)th, (2N+1)th... call through.
+	template <uint64_t N>
+	class EveryN
+	{
+		static_assert(N > 0, "SimpleLogger: LOG_EVERY_N needs N > 0");
+
+	public:
+		bool allow() { return m_Calls.fetch_add(1, std::memory_order_relaxed) % N == 0; }
+
+	private:
+		std::atomic<uint64_t> m_Calls{ 0 };
+	};
+
+	// Lets the first N calls through. Once they have passed, a call is only a
+	// load, so a statement spinning forever doesn't keep writing the line.
+	template <uint64_t N>
+	class FirstN
+	{
+	public:
+		bool allow()
+		{
+			if (m_Calls.load(std::memory_order_relaxed) >= N)
+				return false;
+			return m_Calls.fetch_add(1, std::memory_order_relaxed) < N;
+		}
+
+	private:
+		std::atomic<uint64_t> m_Calls{ 0 };
+	};
+
+	// Lets at most one call per Milliseconds through. The common, rejected
+	// case is a clock read and one comparison; only the winner of a period
+	// does a compare-and-swap.
+	template <uint64_t Milliseconds>
+	class EveryInterval
+	{
+	public:
+		bool allow()
+		{
+			const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+			int64_t next = m_Next.load(std::memory_order_relaxed);
+			if (now < next)
+				return false;
+			return m_Next.compare_exchange_strong(next, now + Interval, std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr int64_t Interval = static_cast<int64_t>(Milliseconds) * 1'000'000;
+
+		std::atomic<int64_t> m_Next{ 0 };
+	};
+}
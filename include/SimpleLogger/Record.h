@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Level.h"
+#include "Metadata.h"
+#include "Platform.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace SimpleLogger
+{
+	class Logger;
+
+	enum class RecordKind : uint8_t
+	{
+		Log,
+		// Barrier used by Backend::flush(): everything queued before it has
+		// been written once the backend reaches it.
+		Flush,
+		// Names the queue's thread (Backend::setThreadName); payload holds
+		// the name. Records queued after it carry the new name.
+		ThreadName
+	};
+
+	enum RecordFlags : uint8_t
+	{
+		// The payload lives in the thread's SpillArena; the record's payload
+		// field holds a SpillReference to it.
+		RecordSpilled = 1 << 0,
+		// Below the logger's level: only kept for its backtrace.
+		RecordBacktrace = 1 << 1
+	};
+
+	struct SpillReference
+	{
+		const char* data;
+		uint64_t end;       // arena position to release after processing
+	};
+
+	// One fixed-size slot of the queue. Producers fill it in place, so it has
+	// to stay trivially copyable and must not own anything. The payload holds
+	// the arguments in the binary form described by metadata->argTypes; the
+	// text is only produced on the backend thread.
+	struct alignas(CacheLineSize) Record
+	{
+		static constexpr size_t Size = 128;
+		static constexpr size_t HeaderSize = 32;
+		static constexpr size_t PayloadSize = Size - HeaderSize;
+
+		uint64_t timestamp;
+		union
+		{
+			const Logger* logger;            // RecordKind::Log
+			std::atomic<bool>* flushed;      // RecordKind::Flush
+		};
+		const Metadata* metadata;
+		uint32_t length;
+		RecordKind kind;
+		Level level;
+		uint8_t flags;
+		uint8_t reserved;
+		char payload[PayloadSize];
+
+		// Where the arguments are, spilled or not.
+		const char* arguments() const
+		{
+			if (!(flags & RecordSpilled))
+				return payload;
+			SpillReference spill;
+			std::memcpy(&spill, payload, sizeof(spill));
+			return spill.data;
+		}
+	};
+
+	static_assert(sizeof(Record) == Record::Size, "Record must fill exactly one slot");
+	static_assert(offsetof(Record, payload) == Record::HeaderSize, "Record header layout changed");
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Level.h"
+#include "Logger.h"
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace SimpleLogger
+{
+	// Owns the named loggers. Lookups take a mutex and are meant for startup
+	// and for operators changing levels, not for the logging path: keep the
+	// returned reference around instead of looking it up per statement.
+	class Registry
+	{
+	public:
+		static Registry& instance();
+
+		Registry(const Registry&) = delete;
+		Registry& operator=(const Registry&) = delete;
+
+		// Returns the existing logger with that name, or creates one.
+		Logger& getOrCreate(std::string_view name, std::vector<std::shared_ptr<Sink>> sinks, Level level = Level::Info);
+		Logger* find(std::string_view name);
+
+		// Sinks shared between loggers, registered under a name so that they
+		// can be looked up when creating loggers or changing sink levels.
+		// Adding a name twice replaces the earlier sink for later lookups.
+		void addSink(std::string name, std::shared_ptr<Sink> sink);
+		std::shared_ptr<Sink> findSink(std::string_view name);
+
+		bool setLevel(std::string_view name, Level level);
+		void setAllLevels(Level level);
+
+		// Applies a spec such as "info,net=debug,db=trace": a bare level sets
+		// every logger, name=level sets one. Entries are separated by commas,
+		// whitespace or newlines. The spec is remembered and also applied to
+		// loggers created later. Returns false if any entry was not understood;
+		// the valid ones are still applied.
+		bool applyLevelSpec(std::string_view spec);
+
+		// Re-reads file with applyLevelSpec() whenever the process receives
+		// signal (SIGUSR1 by default, where available). The handler only sets a
+		// flag; the file is read on the backend thread.
+		void reloadLevelsOnSignal(std::filesystem::path file, int signal = -1);
+
+	private:
+		Registry();
+		~Registry() = default;
+
+		friend void pollLevelReload();
+		void reloadLevels();
+
+		std::mutex m_Mutex;
+		std::vector<std::unique_ptr<Logger>> m_Loggers;
+		std::vector<std::pair<std::string, std::shared_ptr<Sink>>> m_Sinks;
+		std::optional<Level> m_SpecDefault;
+		std::vector<std::pair<std::string, Level>> m_SpecLevels;
+		std::filesystem::path m_LevelFile;
+	};
+
+	// Called by the backend thread; cheap unless a reload signal arrived.
+	void pollLevelReload();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Compression.h"
+#include "FileSink.h"
+#include "TaskThread.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace SimpleLogger
+{
+	struct RotationPolicy
+	{
+		enum class Interval
+		{
+			None,
+			Hourly,
+			Daily
+		};
+
+		// Rotate before a write would take the file past this size; 0 disables.
+		size_t maxBytes = 0;
+		// Rotate at the first write after each local hour or midnight.
+		Interval interval = Interval::None;
+		// Rotated files kept as "<stem>.1<ext>" (newest) .. "<stem>.N<ext>";
+		// 0 keeps all of them.
+		size_t keepFiles = 5;
+		// Rotated files are compressed on the shared compressionPool() and
+		// kept as "<stem>.N<ext>.zst" (or ".lz4"). A file waits as
+		// "<path>.<n>.rotated" until it is compressed, and stays there if
+		// compression fails.
+		CompressionOptions compression;
+	};
+
+	// FileSink that rotates by size and/or time. The file the sink switches to
+	// is opened ahead of time as "<path>.next" on a housekeeping thread, and
+	// the renames and deletes happen there too: on the backend thread a
+	// rotation is only an exchange of file descriptors. If the next file isn't
+	// ready yet the rotation is postponed rather than waited for.
+	class RotatingFileSink : public FileSink
+	{
+	public:
+		// Throws std::system_error if the file can't be opened or the codec
+		// wasn't built in.
+		RotatingFileSink(const std::filesystem::path& path, RotationPolicy rotation, FlushPolicy flush = {});
+		~RotatingFileSink() override;
+
+		// Completed rotations.
+		size_t rotations() const { return m_Rotations; }
+
+	protected:
+		void beforeWriteOut(size_t bytes) override;
+
+	private:
+		// Shared with the tasks on the housekeeping thread.
+		struct State
+		{
+			std::filesystem::path path;
+			std::filesystem::path nextPath;
+			RotationPolicy policy;
+			std::atomic<int> nextFd{ -1 };
+
+			// Housekeeping thread only.
+			uint64_t nextRotated = 0;
+
+			// Compressed files are installed in rotation order by whichever
+			// worker finishes the oldest one.
+			std::mutex mutex;
+			std::condition_variable idle;
+			std::map<uint64_t, bool> compressed;
+			uint64_t nextInstall = 0;
+			size_t compressing = 0;
+		};
+
+		static void prepareNext(State& state);
+		// pool is null when rotated files aren't compressed.
+		static void archive(const std::shared_ptr<State>& state, TaskThread* pool, int previousFd);
+		static void compress(State& state, uint64_t index);
+		static void shiftArchives(State& state);
+		static std::filesystem::path archivePath(const State& state, size_t index);
+		static std::filesystem::path rotatedPath(const State& state, uint64_t index);
+
+		std::time_t nextBoundary(std::time_t now) const;
+
+		std::shared_ptr<State> m_State;
+		size_t m_FileBytes = 0;
+		std::time_t m_Boundary = 0;
+		size_t m_Rotations = 0;
+		std::shared_ptr<TaskThread> m_Compression;
+		std::unique_ptr<TaskThread> m_Housekeeping;
+	};
+}
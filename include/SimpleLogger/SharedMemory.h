@@ -0,0 +1,158 @@
+#pragma once
+
+#include "BinaryFormat.h"
+#include "Formatter.h"
+#include "Sink.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleLogger
+{
+	namespace detail
+	{
+		struct SharedSegmentHeader;
+		struct SharedRingHeader;
+	}
+
+	struct SharedMemoryOptions
+	{
+		// Number of processes that can write to the segment at once.
+		uint32_t processes = 16;
+		// Bytes of ring per process, rounded up to a power of two.
+		size_t ringSize = 4 * 1024 * 1024;
+	};
+
+	// Hands records to a SharedMemoryCollector in another process through a
+	// POSIX shared memory segment. Each process claims one ring of the
+	// segment, and since only the backend thread writes to sinks the ring
+	// has a single producer. Records go in as BinaryFormat frames, the
+	// arguments exactly as the logging thread packed them: the steady state
+	// costs a copy and a release store per record, no syscalls.
+	//
+	// A record that doesn't fit because the collector fell behind is dropped
+	// and counted. Records already in the ring survive the process: the ring
+	// stays in the segment until the collector has drained it. Records still
+	// in the process's own queues only get there if the backend writes them
+	// out before the process dies, as installCrashHandler() arranges for
+	// crashing signals; after SIGKILL they are lost.
+	//
+	// Create the sink in each worker, after fork(); a child must not keep
+	// writing to its parent's ring.
+	class SharedMemorySink : public Sink
+	{
+	public:
+		// Attaches to the segment a SharedMemoryCollector created under name,
+		// such as "/myapp-logs". Throws std::system_error if there is none or
+		// every ring is taken.
+		explicit SharedMemorySink(const std::string& name);
+		~SharedMemorySink() override;
+
+		SharedMemorySink(const SharedMemorySink&) = delete;
+		SharedMemorySink& operator=(const SharedMemorySink&) = delete;
+
+		bool wantsText() const override { return false; }
+		void write(const LogEvent& event) override;
+		// The collector reads straight from the ring; there is nothing to flush.
+		void flush() override {}
+
+		// Records that didn't fit in the ring.
+		uint64_t droppedRecords() const;
+
+	private:
+		bool push(bool streamStart);
+
+		void* m_Segment = nullptr;
+		size_t m_SegmentSize = 0;
+		detail::SharedSegmentHeader* m_Header = nullptr;
+		detail::SharedRingHeader* m_Ring = nullptr;
+		char* m_Data = nullptr;
+		uint64_t m_RingSize = 0;
+		uint64_t m_Tail = 0;
+		uint64_t m_Epoch = 0;
+		bool m_StreamStart = true;
+
+		BinaryFormat::Encoder m_Encoder;
+		std::string m_Frame;
+	};
+
+	// Drains the rings of a shared memory segment into sinks, merging the
+	// processes' records by timestamp. The sinks see the same LogEvents as in
+	// the writing process, except that LogEvent::thread holds its pid and
+	// each logger name maps to a Logger of the collector's own.
+	//
+	// Frames are copied out of the ring and checked like a binary log file
+	// before anything formats them, so a buggy writer only loses its own
+	// records.
+	//
+	// Rings of processes that exited, cleanly or not, are drained and then
+	// handed out again. When a collector restarts, records written before it
+	// attached that refer to format strings the previous one already read
+	// are skipped and counted as dropped; the writers define everything again
+	// from their next record.
+	class SharedMemoryCollector
+	{
+	public:
+		// Creates the segment, or attaches to an existing one and keeps its
+		// geometry. Throws std::system_error if that fails.
+		SharedMemoryCollector(const std::string& name, std::vector<std::shared_ptr<Sink>> sinks, SharedMemoryOptions options = {});
+		~SharedMemoryCollector();
+
+		SharedMemoryCollector(const SharedMemoryCollector&) = delete;
+		SharedMemoryCollector& operator=(const SharedMemoryCollector&) = delete;
+
+		// Writes out what the rings hold, oldest record first, and returns
+		// the number of records written. Call from one thread only.
+		size_t poll();
+		void flush();
+
+		// Records the writers dropped, or that this collector had to skip.
+		uint64_t droppedRecords() const { return m_Dropped; }
+
+		// Removes the segment's name; mappings that exist stay valid.
+		static bool remove(const std::string& name);
+
+	private:
+		struct Ring
+		{
+			detail::SharedRingHeader* header;
+			char* data;
+			uint64_t head = 0;
+			bool synced = false;
+			uint64_t droppedSeen = 0;
+			BinaryFormat::Decoder decoder;
+			bool pending = false;
+			BinaryFormat::Decoder::Record record{};
+			std::string frame;      // holds record's payload
+		};
+
+		struct NameHash
+		{
+			using is_transparent = void;
+			size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+		};
+
+		bool peek(Ring& ring);
+		void release(Ring& ring);
+		void dispatch(const LogEvent& event);
+
+		void* m_Segment = nullptr;
+		size_t m_SegmentSize = 0;
+		uint64_t m_RingSize = 0;
+		std::vector<Ring> m_Rings;
+		std::vector<std::shared_ptr<Sink>> m_Sinks;
+		std::unordered_map<std::string, std::unique_ptr<Logger>, NameHash, std::equal_to<>> m_Loggers;
+
+		Formatter m_Formatter;
+		std::string m_Lines[LayoutCount];
+		std::chrono::steady_clock::time_point m_LastLivenessCheck{};
+		uint64_t m_Dropped = 0;
+	};
+}
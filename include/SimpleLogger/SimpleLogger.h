@@ -0,0 +1,22 @@
+#pragma once
+
+#include "AsyncSink.h"
+#include "Backend.h"
+#include "BinarySink.h"
+#include "CompressedFileSink.h"
+#include "Compression.h"
+#include "ConsoleSink.h"
+#include "CrashHandler.h"
+#include "FileSink.h"
+#include "Level.h"
+#include "Logger.h"
+#include "Macros.h"
+#include "Metrics.h"
+#include "MmapSink.h"
+#include "NetworkSink.h"
+#include "Pattern.h"
+#include "Registry.h"
+#include "RotatingFileSink.h"
+#include "SharedMemory.h"
+#include "Sink.h"
+#include "UringFileSink.h"
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Layout.h"
+#include "Level.h"
+#include "Metadata.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace SimpleLogger
+{
+	class Logger;
+	class Pattern;
+
+	// What a sink receives for each record: the record in its binary form and,
+	// for sinks that want it, the formatted line.
+	struct LogEvent
+	{
+		uint64_t wallTime;          // nanoseconds since the Unix epoch
+		Level level;
+		const Logger* logger;
+		const Metadata* metadata;
+		const char* payload;        // arguments, encoded as in Arguments.h
+		uint32_t payloadLength;
+		std::string_view line;      // empty unless the sink wantsText()
+		uint32_t thread;            // OS id of the thread that logged
+		std::string_view threadName; // empty unless set with Backend::setThreadName()
+	};
+
+	// Destination for log records. Sinks are only ever called from the
+	// backend thread, so implementations don't need their own locking. One
+	// sink can be shared by several loggers; each record is formatted once per
+	// layout and the same line is handed to every sink that wants it.
+	class Sink
+	{
+	public:
+		virtual ~Sink() = default;
+
+		virtual void write(const LogEvent& event) = 0;
+
+		// The backend only formats a record if one of its sinks wants text.
+		virtual bool wantsText() const { return true; }
+
+		// Layout of LogEvent::line. Records are formatted once per layout,
+		// however many sinks share it. Set before logging to the sink.
+		Layout layout() const { return m_Layout; }
+		void setLayout(Layout layout) { m_Layout = layout; }
+
+		// Formats lines by pattern (see Pattern.h) and switches the layout to
+		// Layout::Pattern; nullptr goes back to Layout::Text. Sinks sharing
+		// one Pattern object share the formatted line. Set before logging to
+		// the sink.
+		void setPattern(std::shared_ptr<const Pattern> pattern)
+		{
+			m_Pattern = std::move(pattern);
+			m_Layout = m_Pattern ? Layout::Pattern : Layout::Text;
+		}
+		const Pattern* pattern() const { return m_Pattern.get(); }
+		const std::shared_ptr<const Pattern>& sharedPattern() const { return m_Pattern; }
+
+		// Records below the sink's level are not passed to it (nor formatted
+		// for it). Applied after the logger's level; can change at any time.
+		Level level() const { return static_cast<Level>(m_Level.load(std::memory_order_relaxed)); }
+		void setLevel(Level level) { m_Level.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+		bool accepts(Level level) const { return static_cast<uint8_t>(level) >= m_Level.load(std::memory_order_relaxed); }
+
+		// Called between batches of records. Sinks apply their flush policy
+		// here and return true while they still hold unwritten data, so that
+		// they get polled again. By default everything is written right away.
+		virtual bool poll()
+		{
+			flush();
+			return false;
+		}
+
+		// Writes out everything buffered.
+		virtual void flush() = 0;
+
+	private:
+		Layout m_Layout = Layout::Text;
+		std::shared_ptr<const Pattern> m_Pattern;
+		std::atomic<uint8_t> m_Level{ static_cast<uint8_t>(Level::Trace) };
+	};
+}
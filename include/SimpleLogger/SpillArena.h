@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Platform.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace SimpleLogger
+{
+	// Per-thread circular byte arena for payloads that don't fit in a record.
+	// The producer bump-allocates; the backend consumes the records of one
+	// thread in order, so it can hand back everything up to a position at
+	// once instead of freeing allocations one by one. Positions only grow;
+	// the offset in the buffer is the position modulo the capacity.
+	class SpillArena
+	{
+	public:
+		explicit SpillArena(size_t capacity)
+			: m_Data(new char[capacity]), m_Capacity(capacity)
+		{
+		}
+
+		SpillArena(const SpillArena&) = delete;
+		SpillArena& operator=(const SpillArena&) = delete;
+
+		// Producer side. Returns size contiguous bytes, or nullptr if the arena
+		// is full. end is the position to release once the backend is done.
+		char* allocate(size_t size, uint64_t& end)
+		{
+			if (size > m_Capacity)
+				return nullptr;
+
+			// An allocation never wraps; the rest of the lap is skipped instead.
+			uint64_t start = m_Allocated;
+			const size_t offset = static_cast<size_t>(start % m_Capacity);
+			if (offset + size > m_Capacity)
+				start += m_Capacity - offset;
+
+			if (start + size - m_CachedReleased > m_Capacity)
+			{
+				m_CachedReleased = m_Released.load(std::memory_order_acquire);
+				if (start + size - m_CachedReleased > m_Capacity)
+					return nullptr;
+			}
+
+			m_Allocated = start + size;
+			end = m_Allocated;
+			return m_Data.get() + start % m_Capacity;
+		}
+
+		// Consumer side: everything allocated before end may be reused.
+		void release(uint64_t end) { m_Released.store(end, std::memory_order_release); }
+
+	private:
+		std::unique_ptr<char[]> m_Data;
+		const size_t m_Capacity;
+
+		alignas(CacheLineSize) uint64_t m_Allocated = 0;
+		uint64_t m_CachedReleased = 0;
+
+		alignas(CacheLineSize) std::atomic<uint64_t> m_Released{ 0 };
+	};
+}
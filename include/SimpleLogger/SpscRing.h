@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Platform.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace SimpleLogger
+{
+	// Bounded single-producer / single-consumer ring. Each side keeps a
+	// private copy of the other side's index and only reloads it when the
+	// ring looks full (producer) or empty (consumer), so in steady state the
+	// two threads don't touch each other's cache lines at all.
+	template <typename T>
+	class SpscRing
+	{
+	public:
+		explicit SpscRing(size_t capacity)
+			: m_Mask(capacity - 1), m_Slots(new T[capacity])
+		{
+			if (capacity < 2 || (capacity & m_Mask) != 0)
+				throw std::invalid_argument("SpscRing capacity must be a power of two");
+		}
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		size_t capacity() const { return m_Mask + 1; }
+
+		// Published records not consumed yet. Exact on the consumer side,
+		// a snapshot anywhere else.
+		size_t size() const
+		{
+			return static_cast<size_t>(m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire));
+		}
+
+		// Producer side. Returns nullptr when the ring is full; otherwise the
+		// slot stays reserved until publish().
+		T* tryAcquire()
+		{
+			const uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+			if (tail - m_CachedHead > m_Mask)
+			{
+				m_CachedHead = m_Head.load(std::memory_order_acquire);
+				if (tail - m_CachedHead > m_Mask)
+					return nullptr;
+			}
+			return &m_Slots[tail & m_Mask];
+		}
+
+		void publish()
+		{
+			m_Tail.store(m_Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Consumer side. Returns nullptr when the ring is empty.
+		T* front()
+		{
+			const uint64_t head = m_Head.load(std::memory_order_relaxed);
+			if (head == m_CachedTail)
+			{
+				m_CachedTail = m_Tail.load(std::memory_order_acquire);
+				if (head == m_CachedTail)
+					return nullptr;
+			}
+			return &m_Slots[head & m_Mask];
+		}
+
+		void pop()
+		{
+			m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Calls visit with every published slot, oldest first, without
+		// consuming any. For crash reports, where the consumer may be gone
+		// or stuck; async-signal-safe as long as visit is.
+		template <typename Visit>
+		void forEachPublished(Visit&& visit) const
+		{
+			const uint64_t tail = m_Tail.load(std::memory_order_acquire);
+			for (uint64_t head = m_Head.load(std::memory_order_acquire); head != tail; head++)
+				visit(m_Slots[head & m_Mask]);
+		}
+
+	private:
+		const size_t m_Mask;
+		std::unique_ptr<T[]> m_Slots;
+
+		alignas(CacheLineSize) std::atomic<uint64_t> m_Tail{ 0 };
+		uint64_t m_CachedHead = 0;
+
+		alignas(CacheLineSize) std::atomic<uint64_t> m_Head{ 0 };
+		uint64_t m_CachedTail = 0;
+	};
+}
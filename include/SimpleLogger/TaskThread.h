@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleLogger
+{
+	// A thread running posted tasks in order. Used for slow file system work
+	// (renames, deletes, opening files) that must never run on the backend
+	// thread. The destructor runs what is still queued, then joins.
+	//
+	// With more than one thread it is a small pool: tasks still start in the
+	// order they were posted, but may run at the same time.
+	class TaskThread
+	{
+	public:
+		explicit TaskThread(size_t threads = 1);
+		~TaskThread();
+
+		TaskThread(const TaskThread&) = delete;
+		TaskThread& operator=(const TaskThread&) = delete;
+
+		void post(std::function<void()> task);
+
+	private:
+		void run();
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Wakeup;
+		std::deque<std::function<void()>> m_Tasks;
+		bool m_Stopping = false;
+		std::vector<std::thread> m_Threads;
+	};
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Record.h"
+#include "SpillArena.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace SimpleLogger
+{
+	// What a log statement does when its thread's queue is full.
+	enum class OverflowPolicy : uint8_t
+	{
+		// Wait for the backend to make room; nothing is lost.
+		Block,
+		// Drop the record and count it; the caller never waits.
+		DropNewest,
+		// Chain a bigger ring onto the queue, up to Backend::MaxThreadQueueCapacity
+		// records in total, then drop like DropNewest.
+		Grow
+	};
+
+	// Staging buffer owned by one producer thread. The thread registers it
+	// with the backend the first time it logs and marks it abandoned when it
+	// exits; the backend frees it once it has drained what is left.
+	//
+	// The queue is a chain of SPSC rings. Normally there is only one; growing
+	// links a bigger ring behind it and the producer moves on to it. The
+	// consumer follows once it has emptied the old ring, and frees it.
+	class ThreadQueue
+	{
+	public:
+		explicit ThreadQueue(size_t capacity)
+			: m_Producer(new Segment(capacity)), m_Consumer(m_Producer), m_Capacity(capacity)
+		{
+		}
+
+		~ThreadQueue()
+		{
+			while (m_Consumer)
+				delete std::exchange(m_Consumer, m_Consumer->next.load(std::memory_order_acquire));
+		}
+
+		ThreadQueue(const ThreadQueue&) = delete;
+		ThreadQueue& operator=(const ThreadQueue&) = delete;
+
+		// Producer side.
+		Record* tryAcquire() { return m_Producer->ring.tryAcquire(); }
+		void publish() { m_Producer->ring.publish(); }
+
+		// Links a ring twice the size of the current one, unless the queue
+		// would exceed maxCapacity. Producer side; allocates.
+		bool grow(size_t maxCapacity)
+		{
+			const size_t size = m_Producer->ring.capacity() * 2;
+			if (m_Capacity + size > maxCapacity)
+				return false;
+
+			Segment* segment = new Segment(size);
+			m_Producer->next.store(segment, std::memory_order_release);
+			m_Producer = segment;
+			m_Capacity += size;
+			return true;
+		}
+
+		// Consumer side.
+		Record* front()
+		{
+			Record* record = m_Consumer->ring.front();
+			if (record)
+				return record;
+
+			Segment* next = m_Consumer->next.load(std::memory_order_acquire);
+			if (!next)
+				return nullptr;
+
+			// The producer stopped using this ring before linking the next one,
+			// but it may have published into it after our first look.
+			record = m_Consumer->ring.front();
+			if (record)
+				return record;
+
+			delete std::exchange(m_Consumer, next);
+			return m_Consumer->ring.front();
+		}
+
+		void pop() { m_Consumer->ring.pop(); }
+
+		// Records pending across all linked rings. Consumer side.
+		size_t size() const
+		{
+			size_t size = 0;
+			for (const Segment* segment = m_Consumer; segment; segment = segment->next.load(std::memory_order_acquire))
+				size += segment->ring.size();
+			return size;
+		}
+
+		// Records not consumed yet, across all linked rings; see
+		// SpscRing::forEachPublished.
+		template <typename Visit>
+		void forEachPending(Visit&& visit) const
+		{
+			for (const Segment* segment = m_Consumer; segment; segment = segment->next.load(std::memory_order_acquire))
+				segment->ring.forEachPublished(visit);
+		}
+
+		std::atomic<bool> abandoned{ false };
+		// OS id of the owning thread, taken once when it registers, so no
+		// record has to carry or look it up.
+		uint32_t threadId = 0;
+		// Consumer side: the name from the last RecordKind::ThreadName.
+		std::string threadName;
+
+		// Created by the producer on its first oversized record, before that
+		// record is published.
+		std::unique_ptr<SpillArena> spill;
+		// Consumer side: arena position to release after the current batch.
+		uint64_t spillConsumed = 0;
+		uint64_t spillReleased = 0;
+
+	private:
+		struct Segment
+		{
+			explicit Segment(size_t capacity)
+				: ring(capacity)
+			{
+			}
+
+			SpscRing<Record> ring;
+			std::atomic<Segment*> next{ nullptr };
+		};
+
+		Segment* m_Producer;
+		Segment* m_Consumer;
+		size_t m_Capacity;  // producer only
+	};
+
+	namespace detail
+	{
+		// Constant-initialized, so reading it needs no TLS init guard.
+		inline thread_local ThreadQueue* t_ThreadQueue = nullptr;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+
+namespace SimpleLogger
+{
+	// Renders "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" in local time. The calendar part
+	// only goes through localtime when the minute changes and the seconds
+	// only when the second changes; otherwise formatting is nine digits
+	// copied from the pair table. Backend thread only.
+	class TimestampFormatter
+	{
+	public:
+		static constexpr size_t Length = 29;
+		static constexpr size_t OffsetLength = 6;
+
+		// The view points into an internal buffer and stays valid until the
+		// next call.
+		std::string_view format(uint64_t wallTime);
+
+		// UTC offset of the last formatted time as "+HH:MM", which RFC 3339
+		// needs to place local time.
+		std::string_view utcOffset() const { return std::string_view(m_Offset, OffsetLength); }
+
+	private:
+		void updateMinute(std::time_t second);
+
+		char m_Buffer[Length + 1] = {};
+		char m_Offset[OffsetLength + 1] = "+00:00";
+		std::time_t m_MinuteStart = 0;
+		std::time_t m_MinuteEnd = 0;
+		std::time_t m_CachedSecond = -1;
+	};
+}
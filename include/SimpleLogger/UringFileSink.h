@@ -0,0 +1,94 @@
+#pragma once
+
+#include "FileSink.h"
+#include "Sink.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace SimpleLogger
+{
+	struct UringOptions
+	{
+		// Buffers that may be in flight at once. The backend only waits for
+		// the disk once all of them are.
+		size_t buffers = 8;
+		// An fdatasync is submitted this often while data is being written;
+		// zero disables it.
+		std::chrono::milliseconds syncInterval{ 1'000 };
+		// false forces the writev fallback.
+		bool useUring = true;
+	};
+
+	// File sink that hands its writes to io_uring (Linux 5.6 and later): a
+	// full buffer is submitted as one write at an explicit file offset and
+	// the next buffer is filled while the kernel works, so the backend thread
+	// doesn't wait for slow or shared disks. Completions are reaped in poll().
+	//
+	// If io_uring can't be used (older kernel, a seccomp profile that blocks
+	// it, or useUring = false) the sink writes each buffer with pwritev() like
+	// FileSink, and fdatasyncs on the backend thread.
+	//
+	// The sink owns the file's end: it appends at the size the file had when
+	// opened, so other writers must not append to the same file.
+	class UringFileSink : public Sink
+	{
+	public:
+		// Throws std::system_error if the file can't be opened.
+		explicit UringFileSink(const std::filesystem::path& path, FlushPolicy policy = {}, UringOptions options = {}, bool truncate = false);
+		~UringFileSink() override;
+
+		UringFileSink(const UringFileSink&) = delete;
+		UringFileSink& operator=(const UringFileSink&) = delete;
+
+		void write(const LogEvent& event) override;
+		bool poll() override;
+		// Submits the current buffer and waits until every write completed.
+		void flush() override;
+
+		bool usingUring() const { return m_Ring != nullptr; }
+		// io_uring_enter or writev calls made so far.
+		size_t writeCalls() const { return m_WriteCalls; }
+
+	private:
+		struct Ring;
+
+		struct Buffer
+		{
+			char* data = nullptr;
+			size_t size = 0;
+			size_t written = 0;       // bytes completed, for short writes
+			uint64_t fileOffset = 0;
+			bool inFlight = false;
+		};
+
+		void submitCurrent();
+		void submitWrite(size_t index);
+		void nextBuffer();
+		void reap(bool wait);
+		void submitSync();
+		void writeDirect(const char* data, size_t size);
+
+		int m_Fd = -1;
+		FlushPolicy m_Policy;
+		UringOptions m_Options;
+		std::unique_ptr<Ring> m_Ring;
+
+		std::vector<Buffer> m_Buffers;
+		size_t m_Capacity = 0;
+		size_t m_Current = 0;
+		size_t m_InFlight = 0;
+		size_t m_Records = 0;
+		uint64_t m_FileOffset = 0;
+		std::chrono::steady_clock::time_point m_OldestRecord;
+
+		bool m_SyncInFlight = false;
+		bool m_WrittenSinceSync = false;
+		std::chrono::steady_clock::time_point m_LastSync;
+		size_t m_WriteCalls = 0;
+	};
+}
@@ -1,7 +1,8 @@
-#include <iostream>
+#include "SimpleLogger/SimpleLogger.h"
 
 int main()
 {
-	std::cout << "Hello World!\n";
+	SimpleLogger::installCrashHandler();
+	LOG_INFO("Hello {}!", "World");
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,155 @@
+#include "SimpleLogger/AsyncSink.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		// How often the worker polls a sink that still holds unwritten data.
+		constexpr std::chrono::milliseconds PollInterval{ 1 };
+	}
+
+	AsyncSink::AsyncSink(std::shared_ptr<Sink> sink, size_t maxBufferedBytes)
+		: m_Sink(std::move(sink)), m_MaxBufferedBytes(maxBufferedBytes), m_WantsText(m_Sink->wantsText())
+	{
+		setLayout(m_Sink->layout());
+		if (m_Sink->pattern())
+			setPattern(m_Sink->sharedPattern());
+		m_Thread = std::thread([this] { run(); });
+	}
+
+	AsyncSink::~AsyncSink()
+	{
+		handOver(true);
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_Wakeup.notify_one();
+		m_Thread.join();
+	}
+
+	void AsyncSink::write(const LogEvent& event)
+	{
+		const size_t size = sizeof(EntryHeader) + event.payloadLength + event.line.size() + event.threadName.size();
+		if (m_Pending.size() + m_QueuedBytes.load(std::memory_order_relaxed) + size > m_MaxBufferedBytes)
+		{
+			m_Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		const EntryHeader header{ event.wallTime, event.logger, event.metadata, event.payloadLength,
+			static_cast<uint32_t>(event.line.size()), event.thread, static_cast<uint8_t>(event.threadName.size()), event.level };
+		m_Pending.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		m_Pending.append(event.payload, event.payloadLength);
+		m_Pending.append(event.line);
+		m_Pending.append(event.threadName);
+	}
+
+	bool AsyncSink::poll()
+	{
+		if (!handOver(false))
+			return true;
+		return m_QueuedBytes.load(std::memory_order_relaxed) != 0 || m_SinkHoldsData.load(std::memory_order_relaxed);
+	}
+
+	void AsyncSink::flush()
+	{
+		handOver(true);
+		std::unique_lock lock(m_Mutex);
+		const uint64_t target = ++m_FlushRequested;
+		m_Wakeup.notify_one();
+		m_Flushed.wait(lock, [&] { return m_FlushCompleted >= target; });
+	}
+
+	bool AsyncSink::handOver(bool wait)
+	{
+		if (m_Pending.empty())
+			return true;
+
+		std::unique_lock lock(m_Mutex, std::defer_lock);
+		if (wait)
+			lock.lock();
+		else if (!lock.try_lock())
+			return false;
+
+		// Swapping hands the worker's drained buffer back for reuse.
+		if (m_Queued.empty())
+			m_Queued.swap(m_Pending);
+		else
+			m_Queued.append(m_Pending);
+		m_Pending.clear();
+		m_QueuedBytes.store(m_Queued.size(), std::memory_order_relaxed);
+		lock.unlock();
+		m_Wakeup.notify_one();
+		return true;
+	}
+
+	void AsyncSink::run()
+	{
+		std::string batch;
+		bool sinkHoldsData = false;
+		std::unique_lock lock(m_Mutex);
+		for (;;)
+		{
+			auto ready = [this] { return m_Stopping || !m_Queued.empty() || m_FlushRequested != m_FlushCompleted; };
+			if (sinkHoldsData)
+				m_Wakeup.wait_for(lock, PollInterval, ready);
+			else
+				m_Wakeup.wait(lock, ready);
+
+			batch.swap(m_Queued);
+			// The batch being written still counts against the limit.
+			m_QueuedBytes.store(batch.size(), std::memory_order_relaxed);
+			const uint64_t flushTarget = m_FlushRequested;
+			const bool flushNeeded = flushTarget != m_FlushCompleted || m_Stopping;
+			const bool stopping = m_Stopping;
+			lock.unlock();
+
+			writeBatch(batch);
+			batch.clear();
+			if (flushNeeded)
+			{
+				m_Sink->flush();
+				sinkHoldsData = false;
+			}
+			else
+			{
+				sinkHoldsData = m_Sink->poll();
+			}
+
+			lock.lock();
+			m_SinkHoldsData.store(sinkHoldsData, std::memory_order_relaxed);
+			m_QueuedBytes.store(m_Queued.size(), std::memory_order_relaxed);
+			if (m_FlushCompleted != flushTarget)
+			{
+				m_FlushCompleted = flushTarget;
+				m_Flushed.notify_all();
+			}
+			if (stopping && m_Queued.empty())
+				return;
+		}
+	}
+
+	void AsyncSink::writeBatch(const std::string& batch)
+	{
+		const char* in = batch.data();
+		const char* const end = in + batch.size();
+		while (in != end)
+		{
+			EntryHeader header;
+			std::memcpy(&header, in, sizeof(header));
+			in += sizeof(header);
+
+			const LogEvent event{ header.wallTime, header.level, header.logger, header.metadata, in, header.payloadLength,
+				std::string_view(in + header.payloadLength, header.lineLength), header.thread,
+				std::string_view(in + header.payloadLength + header.lineLength, header.threadNameLength) };
+			in += header.payloadLength + header.lineLength + header.threadNameLength;
+
+			if (m_Sink->accepts(event.level))
+				m_Sink->write(event);
+		}
+	}
+}
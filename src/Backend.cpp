@@ -0,0 +1,736 @@
+#include "SimpleLogger/Backend.h"
+
+#include "SimpleLogger/Logger.h"
+#include "SimpleLogger/Registry.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		// Marks the thread's queue abandoned when the thread exits. Kept apart
+		// from t_ThreadQueue so that the hot path reads a plain pointer.
+		struct ThreadQueueGuard
+		{
+			~ThreadQueueGuard()
+			{
+				if (ThreadQueue* queue = detail::t_ThreadQueue)
+				{
+					detail::t_ThreadQueue = nullptr;
+					queue->abandoned.store(true, std::memory_order_release);
+				}
+			}
+		};
+
+		thread_local ThreadQueueGuard t_ThreadQueueGuard;
+		// Set on the backend thread, so a crash there doesn't wait for itself.
+		thread_local bool t_IsBackendThread = false;
+
+		std::atomic<Backend*> s_Instance{ nullptr };
+
+		using LevelMetadata = std::array<Metadata, static_cast<size_t>(Level::Off) + 1>;
+
+		// The backend's own records take the level of the record they report
+		// on, and a format's level is written to a binary log only with its
+		// definition, so each level needs a Metadata of its own.
+		constexpr LevelMetadata levelMetadata(const char* format, uint32_t line, const ArgType* argTypes)
+		{
+			LevelMetadata metadata{};
+			for (size_t i = 0; i < metadata.size(); i++)
+				metadata[i] = { format, __FILE__, line, static_cast<Level>(i), 1, argTypes };
+			return metadata;
+		}
+
+		uint32_t currentThreadId()
+		{
+#if defined(__linux__)
+			return static_cast<uint32_t>(::syscall(SYS_gettid));
+#else
+			return static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+		}
+
+		// clock_gettime and nanosleep are async-signal-safe; steady_clock and
+		// sleep_for don't promise to be.
+		uint64_t monotonicNanoseconds()
+		{
+#if defined(_WIN32)
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+			timespec now;
+			::clock_gettime(CLOCK_MONOTONIC, &now);
+			return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + static_cast<uint64_t>(now.tv_nsec);
+#endif
+		}
+
+		void cpuRelax()
+		{
+#if defined(SIMPLELOGGER_TICKS_RDTSC)
+			_mm_pause();
+#elif defined(__aarch64__)
+			asm volatile("yield");
+#endif
+		}
+
+		// Returns early if word no longer holds expected, or once woken.
+		void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeout)
+		{
+#if defined(__linux__)
+			const timespec duration{ static_cast<time_t>(timeout / 1'000'000'000), static_cast<long>(timeout % 1'000'000'000) };
+			::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &duration, nullptr, 0);
+#else
+			if (word.load(std::memory_order_acquire) == expected)
+				std::this_thread::sleep_for(std::chrono::nanoseconds(timeout));
+#endif
+		}
+
+		void pause()
+		{
+#if defined(_WIN32)
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+#else
+			const timespec duration{ 0, 200'000 };
+			::nanosleep(&duration, nullptr);
+#endif
+		}
+	}
+
+	Backend& Backend::instance()
+	{
+		static Backend backend;
+		return backend;
+	}
+
+	Backend* Backend::existing()
+	{
+		return s_Instance.load(std::memory_order_acquire);
+	}
+
+	Backend::Backend()
+	{
+		m_Thread = std::thread([this] { run(); });
+		s_Instance.store(this, std::memory_order_release);
+	}
+
+	Backend::~Backend()
+	{
+		stop();
+		s_Instance.store(nullptr, std::memory_order_release);
+
+		// Queues of threads that are still running (or that logged during
+		// static destruction) are only freed here.
+		adoptNewQueues();
+		for (ThreadQueue* queue : m_Queues)
+			delete queue;
+		m_Queues.clear();
+	}
+
+	ThreadQueue* Backend::registerThread()
+	{
+		// Touch the guard so that its destructor runs when this thread exits.
+		(void)&t_ThreadQueueGuard;
+
+		ThreadQueue* queue = new ThreadQueue(ThreadQueueCapacity);
+		queue->threadId = currentThreadId();
+		{
+			std::lock_guard lock(m_NewQueuesMutex);
+			m_NewQueues.push_back(queue);
+			m_HasNewQueues.store(true, std::memory_order_release);
+		}
+		detail::t_ThreadQueue = queue;
+		return queue;
+	}
+
+	Record* Backend::acquireFull(ThreadQueue& queue, OverflowPolicy policy)
+	{
+		if (policy == OverflowPolicy::Grow && queue.grow(MaxThreadQueueCapacity))
+			return queue.tryAcquire();
+		if (policy != OverflowPolicy::Block)
+			return nullptr;
+
+		Record* record = nullptr;
+		while (!record)
+		{
+			std::this_thread::yield();
+			record = queue.tryAcquire();
+		}
+		return record;
+	}
+
+	void Backend::adoptNewQueues()
+	{
+		if (!m_HasNewQueues.load(std::memory_order_acquire))
+			return;
+
+		std::lock_guard lock(m_NewQueuesMutex);
+		m_Queues.insert(m_Queues.end(), m_NewQueues.begin(), m_NewQueues.end());
+		m_NewQueues.clear();
+		m_HasNewQueues.store(false, std::memory_order_relaxed);
+	}
+
+	void Backend::releaseAbandonedQueues()
+	{
+		std::erase_if(m_Queues, [](ThreadQueue* queue)
+		{
+			// The abandoned flag is set after the thread's last publish, so an
+			// empty ring seen after it means nothing else can arrive.
+			if (!queue->abandoned.load(std::memory_order_acquire) || queue->front())
+				return false;
+			delete queue;
+			return true;
+		});
+	}
+
+	void Backend::setThreadName(std::string_view name)
+	{
+		Record* record = acquire(OverflowPolicy::Block);
+		if (!record)
+			return;
+		record->timestamp = now();
+		record->kind = RecordKind::ThreadName;
+		record->flags = 0;
+		record->length = static_cast<uint32_t>(std::min(name.size(), Record::PayloadSize));
+		std::memcpy(record->payload, name.data(), record->length);
+		publish();
+	}
+
+	void Backend::flush()
+	{
+		if (!m_Running.load(std::memory_order_acquire))
+			return;
+
+		std::atomic<bool> flushed{ false };
+		Record* record = acquire(OverflowPolicy::Block);
+		if (!record)
+			return;
+		record->timestamp = now();
+		record->kind = RecordKind::Flush;
+		record->flags = 0;
+		record->flushed = &flushed;
+		publish();
+		wakeup();
+
+		while (!flushed.load(std::memory_order_acquire))
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+
+	bool Backend::flush(std::chrono::nanoseconds timeout)
+	{
+		if (!m_Running.load(std::memory_order_acquire))
+			return true;
+
+		// The backend may set the flag after we gave up, so it can't live on
+		// this stack; on a timeout it is leaked.
+		auto* flushed = new std::atomic<bool>(false);
+		Record* record = acquire(OverflowPolicy::Block);
+		if (!record)
+		{
+			delete flushed;
+			return false;
+		}
+		record->timestamp = now();
+		record->kind = RecordKind::Flush;
+		record->flags = 0;
+		record->flushed = flushed;
+		publish();
+
+		wakeup();
+
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (!flushed->load(std::memory_order_acquire))
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+				return false;
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		delete flushed;
+		return true;
+	}
+
+	bool Backend::drainForCrash(std::chrono::nanoseconds timeout)
+	{
+		m_Closed.store(true, std::memory_order_relaxed);
+		if (t_IsBackendThread || !m_Running.load(std::memory_order_acquire))
+			return false;
+
+		uint8_t expected = NoCrashDrain;
+		m_CrashDrain.compare_exchange_strong(expected, CrashDrainRequested, std::memory_order_acq_rel);
+		wake();
+
+		const uint64_t deadline = monotonicNanoseconds() + static_cast<uint64_t>(timeout.count());
+		while (m_CrashDrain.load(std::memory_order_acquire) != CrashDrainDone)
+		{
+			if (monotonicNanoseconds() >= deadline)
+				return false;
+			pause();
+		}
+		return true;
+	}
+
+	void Backend::stop()
+	{
+		if (!m_Running.exchange(false, std::memory_order_acq_rel))
+			return;
+		wake();
+		if (m_Thread.joinable())
+			m_Thread.join();
+	}
+
+	bool Backend::configure(const BackendOptions& options)
+	{
+		m_IdlePolicy.store(static_cast<uint8_t>(options.idlePolicy), std::memory_order_relaxed);
+		m_SpinDuration.store(std::chrono::nanoseconds(options.spinDuration).count(), std::memory_order_relaxed);
+		m_SleepInterval.store(std::chrono::nanoseconds(options.sleepInterval).count(), std::memory_order_relaxed);
+		m_MaxBatch.store(std::max<size_t>(options.maxBatch, 1), std::memory_order_relaxed);
+		m_Cpu.store(options.cpu, std::memory_order_relaxed);
+		// A sleeping backend picks up the new policy now rather than after
+		// the old interval.
+		wake();
+
+		if (options.cpu < 0)
+			return true;
+#if defined(__linux__)
+		if (options.cpu >= CPU_SETSIZE)
+			return false;
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(options.cpu, &cpus);
+		return ::pthread_setaffinity_np(m_Thread.native_handle(), sizeof(cpus), &cpus) == 0;
+#else
+		return false;
+#endif
+	}
+
+	BackendOptions Backend::options() const
+	{
+		BackendOptions options;
+		options.cpu = m_Cpu.load(std::memory_order_relaxed);
+		options.idlePolicy = static_cast<IdlePolicy>(m_IdlePolicy.load(std::memory_order_relaxed));
+		options.spinDuration = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::nanoseconds(m_SpinDuration.load(std::memory_order_relaxed)));
+		options.sleepInterval = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::nanoseconds(m_SleepInterval.load(std::memory_order_relaxed)));
+		options.maxBatch = m_MaxBatch.load(std::memory_order_relaxed);
+		return options;
+	}
+
+	void Backend::wake()
+	{
+		m_WakeupSequence.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+		::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_WakeupSequence), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+	}
+
+	void Backend::idle(uint64_t& idleSince)
+	{
+		switch (static_cast<IdlePolicy>(m_IdlePolicy.load(std::memory_order_relaxed)))
+		{
+		case IdlePolicy::Spin:
+			cpuRelax();
+			break;
+
+		case IdlePolicy::SpinThenYield:
+		{
+			const uint64_t ticks = now();
+			if (idleSince == 0)
+				idleSince = ticks;
+			if (static_cast<double>(ticks - idleSince) * m_Clock.nanosecondsPerTick() < static_cast<double>(m_SpinDuration.load(std::memory_order_relaxed)))
+				cpuRelax();
+			else
+				std::this_thread::yield();
+			break;
+		}
+
+		case IdlePolicy::Sleep:
+		{
+			// wakeup() publishes, fences and then reads m_Sleeping; here it is
+			// the other way round, so either the producer sees the flag or
+			// the record is seen below. A wakeup in between changes the
+			// sequence, and the wait returns at once.
+			const uint32_t sequence = m_WakeupSequence.load(std::memory_order_acquire);
+			m_Sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!hasPendingRecords() && m_Running.load(std::memory_order_acquire))
+				futexWait(m_WakeupSequence, sequence, m_SleepInterval.load(std::memory_order_relaxed));
+			m_Sleeping.store(false, std::memory_order_relaxed);
+			break;
+		}
+		}
+	}
+
+	bool Backend::hasPendingRecords()
+	{
+		if (m_HasNewQueues.load(std::memory_order_acquire))
+			return true;
+		return std::any_of(m_Queues.begin(), m_Queues.end(), [](ThreadQueue* queue) { return queue->front() != nullptr; });
+	}
+
+	void Backend::run()
+	{
+		t_IsBackendThread = true;
+		// Producers can already queue records while this runs.
+		m_Clock.calibrate();
+		m_RateTicks = now();
+
+		uint64_t idleSince = 0;
+		while (m_Running.load(std::memory_order_acquire))
+		{
+			if (m_CrashDrain.load(std::memory_order_acquire) == CrashDrainRequested) [[unlikely]]
+			{
+				// No new records are accepted, so this ends.
+				while (drain() != 0)
+				{
+				}
+				flushSinks();
+				m_CrashDrain.store(CrashDrainDone, std::memory_order_release);
+			}
+
+			pollLevelReload();
+			m_Clock.recalibrateIfDue(now());
+			const size_t processed = drain();
+			if (processed == 0)
+				reportExpiredRepeats(now());
+			pollSinks();
+			updateRates(now());
+			if (processed == 0)
+			{
+				releaseAbandonedQueues();
+				idle(idleSince);
+			}
+			else
+			{
+				idleSince = 0;
+			}
+		}
+
+		// Producers may still have published records after stop() was requested.
+		while (drain() != 0)
+		{
+		}
+		flushSinks();
+	}
+
+	size_t Backend::drain()
+	{
+		adoptNewQueues();
+		sampleQueues();
+
+		const size_t maxBatch = m_MaxBatch.load(std::memory_order_relaxed);
+		size_t processed = 0;
+		uint64_t records = 0;
+		while (processed < maxBatch)
+		{
+			// Merge: take the oldest record at the front of any queue.
+			ThreadQueue* oldest = nullptr;
+			Record* oldestRecord = nullptr;
+			for (ThreadQueue* queue : m_Queues)
+			{
+				Record* record = queue->front();
+				if (record && (!oldestRecord || record->timestamp < oldestRecord->timestamp))
+				{
+					oldest = queue;
+					oldestRecord = record;
+				}
+			}
+
+			if (!oldest)
+				break;
+
+			if (oldestRecord->kind == RecordKind::Log)
+			{
+				if (records++ == 0)
+					sampleLag(oldestRecord->timestamp);
+			}
+			process(*oldestRecord, *oldest);
+			// Slots are reused, so only log records' flags are meaningful.
+			if (oldestRecord->kind == RecordKind::Log && (oldestRecord->flags & RecordSpilled))
+			{
+				SpillReference spill;
+				std::memcpy(&spill, oldestRecord->payload, sizeof(spill));
+				oldest->spillConsumed = spill.end;
+			}
+			oldest->pop();
+			processed++;
+		}
+
+		// Hand spilled payloads back once per batch rather than per record.
+		for (ThreadQueue* queue : m_Queues)
+		{
+			if (queue->spillConsumed != queue->spillReleased)
+			{
+				queue->spill->release(queue->spillConsumed);
+				queue->spillReleased = queue->spillConsumed;
+			}
+		}
+
+		detail::MetricCounters::add(m_Metrics.records, records);
+		detail::MetricCounters::add(m_Metrics.bytes, std::exchange(m_BatchBytes, 0));
+		return processed;
+	}
+
+	void Backend::sampleQueues()
+	{
+		size_t depth = 0;
+		size_t deepest = 0;
+		for (const ThreadQueue* queue : m_Queues)
+		{
+			const size_t size = queue->size();
+			depth += size;
+			deepest = std::max(deepest, size);
+		}
+		m_Metrics.queueDepth.store(depth, std::memory_order_relaxed);
+		detail::MetricCounters::raise(m_Metrics.queueHighWater, deepest);
+	}
+
+	void Backend::sampleLag(uint64_t timestamp)
+	{
+		// Another core's tick counter may be slightly ahead of this one.
+		const int64_t ticks = static_cast<int64_t>(now() - timestamp);
+		const uint64_t lag = ticks > 0 ? static_cast<uint64_t>(static_cast<double>(ticks) * m_Clock.nanosecondsPerTick()) : 0;
+		m_Metrics.lag.store(lag, std::memory_order_relaxed);
+		detail::MetricCounters::raise(m_Metrics.maxLag, lag);
+	}
+
+	void Backend::recordSinkTime(uint64_t startTicks)
+	{
+		const uint64_t elapsed = static_cast<uint64_t>(static_cast<double>(now() - startTicks) * m_Clock.nanosecondsPerTick());
+		size_t bucket = 0;
+		while (bucket + 1 < FlushLatencyBuckets && elapsed > flushLatencyBound(bucket))
+			bucket++;
+		detail::MetricCounters::add(m_Metrics.flushLatency[bucket], 1);
+		detail::MetricCounters::add(m_Metrics.flushLatencySum, elapsed);
+		detail::MetricCounters::add(m_Metrics.flushes, 1);
+	}
+
+	void Backend::updateRates(uint64_t ticks)
+	{
+		const double elapsed = static_cast<double>(ticks - m_RateTicks) * m_Clock.nanosecondsPerTick();
+		if (elapsed < static_cast<double>(MetricsInterval))
+			return;
+
+		const uint64_t records = m_Metrics.records.load(std::memory_order_relaxed);
+		const uint64_t bytes = m_Metrics.bytes.load(std::memory_order_relaxed);
+		m_Metrics.recordsPerSecond.store(static_cast<uint64_t>(static_cast<double>(records - m_RateRecords) * 1e9 / elapsed), std::memory_order_relaxed);
+		m_Metrics.bytesPerSecond.store(static_cast<uint64_t>(static_cast<double>(bytes - m_RateBytes) * 1e9 / elapsed), std::memory_order_relaxed);
+		m_RateTicks = ticks;
+		m_RateRecords = records;
+		m_RateBytes = bytes;
+	}
+
+	void Backend::process(Record& record, ThreadQueue& queue)
+	{
+		if (record.kind == RecordKind::Flush)
+		{
+			flushSinks();
+			record.flushed->store(true, std::memory_order_release);
+			return;
+		}
+		if (record.kind == RecordKind::ThreadName)
+		{
+			queue.threadName.assign(record.payload, record.length);
+			return;
+		}
+
+		LogEvent event{
+			m_Clock.toWallTime(record.timestamp),
+			record.level,
+			record.logger,
+			record.metadata,
+			record.arguments(),
+			record.length,
+			{},
+			queue.threadId,
+			queue.threadName
+		};
+
+		// Report drops at the position where they happened, before the first
+		// record that made it through afterwards.
+		if (record.logger->droppedRecords() != 0) [[unlikely]]
+			reportDropped(*record.logger, event);
+
+		const Logger& logger = *record.logger;
+		if (record.flags & RecordBacktrace)
+		{
+			logger.m_Backtrace.push(logger.backtraceRecords(), event.wallTime, event.level, event.metadata, event.thread, event.threadName, event.payload, event.payloadLength);
+			return;
+		}
+		if (event.level >= Logger::BacktraceTrigger && !logger.m_Backtrace.empty()) [[unlikely]]
+			writeBacktrace(logger, event);
+
+		if (logger.suppressRepeats() && isRepeat(logger, event, record.timestamp))
+			return;
+
+		dispatch(logger, event);
+	}
+
+	void Backend::writeBacktrace(const Logger& logger, const LogEvent& trigger)
+	{
+		static constexpr ArgType BacktraceArgs[] = { ArgType::UInt64 };
+		static constexpr LevelMetadata BacktraceMetadata = levelMetadata("backtrace: the last {} records before this error", __LINE__, BacktraceArgs);
+
+		char payload[sizeof(uint64_t)];
+		const size_t length = encodeArguments(payload, sizeof(payload), static_cast<uint64_t>(logger.m_Backtrace.size()));
+		LogEvent header{ trigger.wallTime, trigger.level, &logger, &BacktraceMetadata[static_cast<size_t>(trigger.level)], payload, static_cast<uint32_t>(length), {}, trigger.thread, trigger.threadName };
+		dispatch(logger, header);
+
+		logger.m_Backtrace.drain([&](const BacktraceBuffer::Entry& entry)
+		{
+			LogEvent event{ entry.wallTime, entry.level, &logger, entry.metadata, entry.payload.data(),
+				static_cast<uint32_t>(entry.payload.size()), {}, entry.thread, entry.threadName };
+			dispatch(logger, event);
+		});
+	}
+
+	void Backend::reportDropped(const Logger& logger, const LogEvent& next)
+	{
+		static constexpr ArgType DroppedArgs[] = { ArgType::UInt64 };
+		static constexpr Metadata DroppedMetadata{ "{} messages dropped", __FILE__, __LINE__, Level::Warn, 1, DroppedArgs };
+
+		const uint64_t dropped = logger.takeDroppedRecords();
+		detail::MetricCounters::add(m_Metrics.dropped, dropped);
+		char payload[sizeof(uint64_t)];
+		const size_t length = encodeArguments(payload, sizeof(payload), dropped);
+
+		// Always WARN, whatever the level of the records that were dropped,
+		// so the event takes its level from the one Metadata.
+		LogEvent event{ next.wallTime, DroppedMetadata.level, &logger, &DroppedMetadata, payload, static_cast<uint32_t>(length), {}, next.thread, next.threadName };
+		dispatch(logger, event);
+	}
+
+	bool Backend::isRepeat(const Logger& logger, const LogEvent& event, uint64_t ticks)
+	{
+		RepeatState& state = m_Repeats[&logger];
+		const std::string_view payload(event.payload, event.payloadLength);
+		if (state.metadata == event.metadata && state.level == event.level && state.payload == payload)
+		{
+			if (state.repeats++ == 0)
+				state.firstRepeatTicks = ticks;
+			state.lastRepeat = event.wallTime;
+			if (repeatsExpired(state, ticks))
+				reportRepeats(logger, state);
+			return true;
+		}
+
+		if (state.repeats != 0)
+			reportRepeats(logger, state);
+		state.metadata = event.metadata;
+		state.level = event.level;
+		state.thread = event.thread;
+		state.threadName.assign(event.threadName);
+		state.payload.assign(payload);
+		return false;
+	}
+
+	// Measured on the records' tick clock, so it doesn't matter when the
+	// backend gets to them.
+	bool Backend::repeatsExpired(const RepeatState& state, uint64_t ticks) const
+	{
+		const double elapsed = static_cast<double>(static_cast<int64_t>(ticks - state.firstRepeatTicks)) * m_Clock.nanosecondsPerTick();
+		return elapsed >= static_cast<double>(RepeatReportInterval);
+	}
+
+	void Backend::reportExpiredRepeats(uint64_t ticks)
+	{
+		for (auto& [logger, state] : m_Repeats)
+		{
+			if (state.repeats != 0 && repeatsExpired(state, ticks))
+				reportRepeats(*logger, state);
+		}
+	}
+
+	void Backend::reportRepeats(const Logger& logger, RepeatState& state)
+	{
+		static constexpr ArgType RepeatArgs[] = { ArgType::UInt64 };
+		static constexpr LevelMetadata RepeatMetadata = levelMetadata("last message repeated {} times", __LINE__, RepeatArgs);
+
+		char payload[sizeof(uint64_t)];
+		const size_t length = encodeArguments(payload, sizeof(payload), state.repeats);
+		state.repeats = 0;
+
+		// At the level of the repeated record, so it reaches the same sinks.
+		LogEvent event{ state.lastRepeat, state.level, &logger, &RepeatMetadata[static_cast<size_t>(state.level)], payload, static_cast<uint32_t>(length), {}, state.thread, state.threadName };
+		dispatch(logger, event);
+	}
+
+	void Backend::dispatch(const Logger& logger, LogEvent& event)
+	{
+		bool formatted[LayoutCount] = {};
+		// Layout::Pattern's line is only shared between sinks with the same
+		// Pattern object.
+		const Pattern* formattedPattern = nullptr;
+		for (const std::shared_ptr<Sink>& sink : logger.sinks())
+		{
+			if (!sink->accepts(event.level))
+				continue;
+
+			if (sink->wantsText())
+			{
+				const size_t layout = static_cast<size_t>(sink->layout());
+				const Pattern* pattern = sink->layout() == Layout::Pattern ? sink->pattern() : nullptr;
+				std::string& line = m_Lines[layout];
+				if (!formatted[layout] || (pattern && pattern != formattedPattern))
+				{
+					line.clear();
+					if (pattern)
+						m_Formatter.formatPattern(*pattern, event.wallTime, event.level, logger.name(), event.thread, event.threadName,
+							*event.metadata, event.payload, line);
+					else
+						m_Formatter.format(sink->layout(), event.wallTime, event.level, logger.name(), *event.metadata, event.payload, line);
+					formatted[layout] = true;
+					if (pattern)
+						formattedPattern = pattern;
+				}
+				event.line = line;
+			}
+
+			sink->write(event);
+			m_BatchBytes += sink->wantsText() ? event.line.size() : event.payloadLength;
+			if (std::find(m_DirtySinks.begin(), m_DirtySinks.end(), sink.get()) == m_DirtySinks.end())
+				m_DirtySinks.push_back(sink.get());
+		}
+	}
+
+	void Backend::pollSinks()
+	{
+		if (m_DirtySinks.empty())
+			return;
+		const uint64_t start = now();
+		std::erase_if(m_DirtySinks, [](Sink* sink) { return !sink->poll(); });
+		recordSinkTime(start);
+	}
+
+	void Backend::flushSinks()
+	{
+		for (auto& [logger, state] : m_Repeats)
+		{
+			if (state.repeats != 0)
+				reportRepeats(*logger, state);
+		}
+		m_Repeats.clear();
+
+		if (m_DirtySinks.empty())
+			return;
+		const uint64_t start = now();
+		for (Sink* sink : m_DirtySinks)
+			sink->flush();
+		m_DirtySinks.clear();
+		recordSinkTime(start);
+	}
+}
@@ -0,0 +1,225 @@
+#include "SimpleLogger/BinaryFormat.h"
+
+#include "SimpleLogger/Logger.h"
+
+#include <cstring>
+
+namespace SimpleLogger::BinaryFormat
+{
+	void Encoder::encode(const LogEvent& event, std::string& out)
+	{
+		const FormatInfo& format = formatInfo(event.metadata, out);
+		const uint64_t logger = loggerId(event.logger, out);
+
+		out.push_back(static_cast<char>(Tag::Record));
+		writeVarint(out, format.id);
+		writeVarint(out, logger);
+		writeVarint(out, zigzag(static_cast<int64_t>(event.wallTime - m_LastTime)));
+		if (format.hasStaticStrings)
+			appendPayload(event, out);
+		else
+			writeString(out, std::string_view(event.payload, event.payloadLength));
+		m_LastTime = event.wallTime;
+	}
+
+	void Encoder::reset()
+	{
+		m_Formats.clear();
+		m_Loggers.clear();
+		m_LoggerNames.clear();
+		m_LastTime = 0;
+	}
+
+	// Static strings and keys are only pointers into this process, so their
+	// bytes are copied into the stream as regular strings and keys.
+	void Encoder::appendPayload(const LogEvent& event, std::string& out)
+	{
+		m_Payload.clear();
+		const char* in = event.payload;
+		for (uint8_t i = 0; i < event.metadata->argCount; i++)
+		{
+			const ArgType type = event.metadata->argTypes[i];
+			const char* start = in;
+			const ArgValue value = decodeArgument(type, in);
+			if (type == ArgType::StaticString || type == ArgType::StaticKey)
+			{
+				const uint32_t length = static_cast<uint32_t>(value.s.size());
+				m_Payload.append(reinterpret_cast<const char*>(&length), sizeof(length));
+				m_Payload.append(value.s);
+			}
+			else
+			{
+				m_Payload.append(start, in);
+			}
+		}
+		writeString(out, m_Payload);
+	}
+
+	// Both ids append their definition to out the first time they are seen,
+	// so it lands right before the record using it.
+	const Encoder::FormatInfo& Encoder::formatInfo(const Metadata* metadata, std::string& out)
+	{
+		const auto [it, inserted] = m_Formats.try_emplace(metadata, FormatInfo{ m_Formats.size(), false });
+		if (inserted)
+		{
+			out.push_back(static_cast<char>(Tag::Format));
+			writeVarint(out, it->second.id);
+			out.push_back(static_cast<char>(metadata->level));
+			writeVarint(out, metadata->line);
+			out.push_back(static_cast<char>(metadata->argCount));
+			for (uint8_t i = 0; i < metadata->argCount; i++)
+			{
+				ArgType type = metadata->argTypes[i];
+				if (type == ArgType::StaticString || type == ArgType::StaticKey)
+				{
+					type = type == ArgType::StaticString ? ArgType::String : ArgType::Key;
+					it->second.hasStaticStrings = true;
+				}
+				out.push_back(static_cast<char>(type));
+			}
+			writeString(out, metadata->file);
+			writeString(out, metadata->format);
+		}
+		return it->second;
+	}
+
+	uint64_t Encoder::loggerId(const Logger* logger, std::string& out)
+	{
+		// A logger destroyed and another created at the same address would
+		// otherwise inherit the old name.
+		auto it = m_Loggers.find(logger);
+		if (it != m_Loggers.end() && m_LoggerNames[it->second] == logger->name())
+			return it->second;
+
+		const uint64_t id = m_LoggerNames.size();
+		m_Loggers[logger] = id;
+		m_LoggerNames.push_back(logger->name());
+
+		out.push_back(static_cast<char>(Tag::Logger));
+		writeVarint(out, id);
+		writeString(out, logger->name());
+		return id;
+	}
+
+	Decoder::Result Decoder::read(Reader& reader, Record& record)
+	{
+		switch (static_cast<Tag>(reader.byte()))
+		{
+		case Tag::Format:
+		{
+			const uint64_t id = reader.varint();
+			FormatEntry entry;
+			const uint8_t level = reader.byte();
+			const uint64_t sourceLine = reader.varint();
+			const uint8_t argCount = reader.byte();
+			for (uint8_t i = 0; i < argCount; i++)
+			{
+				const uint8_t type = reader.byte();
+				if (type > static_cast<uint8_t>(ArgType::String) && type != static_cast<uint8_t>(ArgType::Key))
+					return corrupt("format");
+				entry.argTypes.push_back(static_cast<ArgType>(type));
+			}
+			entry.file = reader.string();
+			entry.format = reader.string();
+			if (reader.failed() || id != m_Formats.size() || level > static_cast<uint8_t>(Level::Off) || !validFormat(entry))
+				return corrupt("format");
+
+			m_Formats.push_back(std::move(entry));
+			FormatEntry& stored = m_Formats.back();
+			stored.metadata = { stored.format.c_str(), stored.file.c_str(), static_cast<uint32_t>(sourceLine),
+				static_cast<Level>(level), argCount, stored.argTypes.data() };
+			return Result::Definition;
+		}
+		case Tag::Logger:
+		{
+			const uint64_t id = reader.varint();
+			const std::string_view name = reader.string();
+			if (reader.failed() || id != m_Loggers.size())
+				return corrupt("logger");
+			m_Loggers.emplace_back(name);
+			return Result::Definition;
+		}
+		case Tag::Record:
+		{
+			const uint64_t format = reader.varint();
+			const uint64_t logger = reader.varint();
+			const uint64_t time = m_Time + static_cast<uint64_t>(unzigzag(reader.varint()));
+			const std::string_view payload = reader.string();
+			if (reader.failed() || format >= m_Formats.size() || logger >= m_Loggers.size() || !validPayload(m_Formats[format], payload))
+				return corrupt("record");
+
+			m_Time = time;
+			record = { time, &m_Formats[format].metadata, m_Loggers[logger], payload };
+			return Result::Record;
+		}
+		default:
+			return corrupt("unknown");
+		}
+	}
+
+	void Decoder::reset()
+	{
+		m_Formats.clear();
+		m_Loggers.clear();
+		m_Time = 0;
+		m_CorruptEntry = nullptr;
+	}
+
+	Decoder::Result Decoder::corrupt(const char* entry)
+	{
+		m_CorruptEntry = entry;
+		return Result::Corrupt;
+	}
+
+	// The formatter trusts what the compiler checked for formats in the
+	// program: placeholders that match the positional arguments, followed
+	// by key and value pairs.
+	bool Decoder::validFormat(const FormatEntry& entry)
+	{
+		const std::vector<ArgType>& types = entry.argTypes;
+		size_t positional = 0;
+		while (positional < types.size() && types[positional] != ArgType::Key)
+			positional++;
+		for (size_t i = positional; i < types.size(); i += 2)
+		{
+			if (i + 1 == types.size() || types[i] != ArgType::Key || types[i + 1] == ArgType::Key)
+				return false;
+		}
+		// Formatting stops at the first NUL, as the c_str() in the metadata does.
+		return SimpleLogger::validFormat(std::string_view(entry.format.c_str()), types.data(), positional);
+	}
+
+	// Checks that the payload holds exactly the arguments the format expects.
+	bool Decoder::validPayload(const FormatEntry& entry, std::string_view payload)
+	{
+		Reader reader(payload.data(), payload.size());
+		for (ArgType type : entry.argTypes)
+		{
+			switch (type)
+			{
+			case ArgType::Bool:
+			case ArgType::Char:    reader.bytes(1); break;
+			case ArgType::Int32:
+			case ArgType::UInt32:
+			case ArgType::Float:   reader.bytes(4); break;
+			case ArgType::Int64:
+			case ArgType::UInt64:
+			case ArgType::Double:
+			case ArgType::Pointer: reader.bytes(8); break;
+			case ArgType::String:
+			case ArgType::Key:
+			{
+				const std::string_view length = reader.bytes(sizeof(uint32_t));
+				uint32_t size = 0;
+				if (!length.empty())
+					std::memcpy(&size, length.data(), sizeof(size));
+				reader.bytes(size);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+		return !reader.failed() && reader.atEnd();
+	}
+}
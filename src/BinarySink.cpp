@@ -0,0 +1,17 @@
+#include "SimpleLogger/BinarySink.h"
+
+namespace SimpleLogger
+{
+	BinarySink::BinarySink(const std::filesystem::path& path, FlushPolicy policy)
+		: FileSink(path, policy, true)
+	{
+		append(BinaryFormat::Magic);
+	}
+
+	void BinarySink::write(const LogEvent& event)
+	{
+		m_Entry.clear();
+		m_Encoder.encode(event, m_Entry);
+		append(m_Entry);
+	}
+}
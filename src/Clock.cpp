@@ -0,0 +1,80 @@
+#include "SimpleLogger/Clock.h"
+
+#include <thread>
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		uint64_t wallTime()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count());
+		}
+
+		uint64_t steadyTime()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+	}
+
+	void TickConverter::calibrate()
+	{
+		const Sample start = sample();
+#if defined(SIMPLELOGGER_USE_STEADY_CLOCK)
+		// Ticks already are nanoseconds; only the epoch offset is needed.
+		m_NanosecondsPerTick = 1.0;
+#else
+		std::this_thread::sleep_for(InitialCalibration);
+		const Sample end = sample();
+		m_NanosecondsPerTick = static_cast<double>(end.steadyTime - start.steadyTime) / static_cast<double>(end.ticks - start.ticks);
+#endif
+		m_BaseTicks = start.ticks;
+		m_BaseWallTime = start.wallTime;
+		m_BaseSteadyTime = start.steadyTime;
+		m_RecalibrationTicks = static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(RecalibrationInterval).count() / m_NanosecondsPerTick);
+		recalibrate();
+	}
+
+	TickConverter::Sample TickConverter::sample()
+	{
+		// Bracket the wall clock read between two tick reads and keep the
+		// tightest of a few attempts, so that preemption between the reads
+		// doesn't skew the pair.
+		Sample best{};
+		uint64_t bestWindow = UINT64_MAX;
+		for (int attempt = 0; attempt < 8; attempt++)
+		{
+			const uint64_t before = now();
+			const uint64_t steady = steadyTime();
+			const uint64_t wall = wallTime();
+			const uint64_t after = now();
+			if (after - before < bestWindow)
+			{
+				bestWindow = after - before;
+				best = { before + (after - before) / 2, wall, steady };
+			}
+		}
+		return best;
+	}
+
+	// The rate comes from steady_clock, which doesn't jump; system_clock only
+	// provides the new epoch offset, so a wall clock step moves timestamps
+	// from here on but never skews the rate.
+	void TickConverter::recalibrate()
+	{
+		const Sample current = sample();
+#if !defined(SIMPLELOGGER_USE_STEADY_CLOCK)
+		if (current.ticks > m_BaseTicks && current.steadyTime > m_BaseSteadyTime)
+		{
+			m_NanosecondsPerTick = static_cast<double>(current.steadyTime - m_BaseSteadyTime)
+				/ static_cast<double>(current.ticks - m_BaseTicks);
+		}
+#endif
+		m_BaseTicks = current.ticks;
+		m_BaseWallTime = current.wallTime;
+		m_BaseSteadyTime = current.steadyTime;
+	}
+}
@@ -0,0 +1,142 @@
+#include "SimpleLogger/CompressedFileSink.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace SimpleLogger
+{
+	CompressedFileSink::CompressedFileSink(const std::filesystem::path& path, CompressionOptions compression, FlushPolicy policy,
+		size_t maxPendingFrames, bool truncate)
+		: m_Policy(policy), m_MaxPendingFrames(maxPendingFrames ? maxPendingFrames : 1), m_State(std::make_shared<State>())
+	{
+		if (compression.codec == Codec::None || !codecAvailable(compression.codec))
+			throw std::system_error(std::make_error_code(std::errc::not_supported), "SimpleLogger: compression codec not built in");
+
+		const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : O_APPEND);
+		m_State->fd = ::open(path.c_str(), flags, 0644);
+		if (m_State->fd < 0)
+			throw std::system_error(errno, std::generic_category(), "SimpleLogger: cannot open " + path.string());
+		m_State->compression = compression;
+		m_Pool = compressionPool();
+		m_Frame.reserve(m_Policy.maxBytes);
+	}
+
+	CompressedFileSink::~CompressedFileSink()
+	{
+		flush();
+	}
+
+	CompressedFileSink::State::~State()
+	{
+		if (fd >= 0)
+			::close(fd);
+	}
+
+	void CompressedFileSink::write(const LogEvent& event)
+	{
+		if (m_Frame.empty())
+			m_OldestRecord = std::chrono::steady_clock::now();
+		m_Frame.append(event.line);
+		m_Records++;
+
+		if ((m_Policy.maxBytes && m_Frame.size() >= m_Policy.maxBytes) || (m_Policy.maxRecords && m_Records >= m_Policy.maxRecords))
+			submitFrame();
+	}
+
+	bool CompressedFileSink::poll()
+	{
+		if (!m_Frame.empty() && (m_Policy.maxLatency.count() == 0 || std::chrono::steady_clock::now() - m_OldestRecord >= m_Policy.maxLatency))
+			submitFrame();
+
+		std::lock_guard lock(m_State->mutex);
+		return !m_Frame.empty() || m_State->pending != 0;
+	}
+
+	void CompressedFileSink::flush()
+	{
+		submitFrame();
+		std::unique_lock lock(m_State->mutex);
+		m_State->done.wait(lock, [this] { return m_State->pending == 0; });
+	}
+
+	uint64_t CompressedFileSink::framesWritten() const
+	{
+		std::lock_guard lock(m_State->mutex);
+		return m_State->frames;
+	}
+
+	uint64_t CompressedFileSink::inputBytes() const
+	{
+		std::lock_guard lock(m_State->mutex);
+		return m_State->inputBytes;
+	}
+
+	uint64_t CompressedFileSink::outputBytes() const
+	{
+		std::lock_guard lock(m_State->mutex);
+		return m_State->outputBytes;
+	}
+
+	void CompressedFileSink::submitFrame()
+	{
+		if (m_Frame.empty())
+			return;
+
+		{
+			std::unique_lock lock(m_State->mutex);
+			m_State->done.wait(lock, [this] { return m_State->pending < m_MaxPendingFrames; });
+			m_State->pending++;
+		}
+
+		std::shared_ptr<State> state = m_State;
+		const uint64_t index = m_NextFrame++;
+		auto frame = std::make_shared<std::string>(std::move(m_Frame));
+		m_Pool->post([state, index, frame] { compress(*state, index, *frame); });
+
+		m_Frame = std::string();
+		m_Frame.reserve(m_Policy.maxBytes);
+		m_Records = 0;
+	}
+
+	void CompressedFileSink::compress(State& state, uint64_t index, std::string& frame)
+	{
+		std::string out;
+		// A frame that fails to compress is dropped: raw bytes would corrupt
+		// the stream.
+		if (!compressFrame(state.compression, frame, out))
+			out.clear();
+
+		std::lock_guard lock(state.mutex);
+		state.inputBytes += out.empty() ? 0 : frame.size();
+		state.compressed.emplace(index, std::move(out));
+
+		// Whichever worker finishes the oldest frame writes out every frame
+		// that is now in order.
+		for (auto it = state.compressed.begin(); it != state.compressed.end() && it->first == state.nextWrite;
+			it = state.compressed.erase(it))
+		{
+			const std::string& data = it->second;
+			size_t offset = 0;
+			while (offset < data.size())
+			{
+				const ssize_t written = ::write(state.fd, data.data() + offset, data.size() - offset);
+				if (written < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					break;
+				}
+				offset += static_cast<size_t>(written);
+			}
+			if (!data.empty())
+				state.frames++;
+			state.outputBytes += offset;
+			state.nextWrite++;
+			state.pending--;
+		}
+		state.done.notify_all();
+	}
+}
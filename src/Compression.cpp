@@ -0,0 +1,182 @@
+#include "SimpleLogger/Compression.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(SIMPLELOGGER_HAS_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(SIMPLELOGGER_HAS_LZ4)
+#include <lz4frame.h>
+#endif
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		// Input per frame when compressing a file.
+		constexpr size_t FileFrameBytes = 4 * 1024 * 1024;
+
+#if defined(SIMPLELOGGER_HAS_ZSTD)
+		bool compressZstd(int level, std::string_view input, std::string& out)
+		{
+			// One context per worker thread, reused for every frame.
+			struct Context
+			{
+				ZSTD_CCtx* context = ZSTD_createCCtx();
+				~Context() { ZSTD_freeCCtx(context); }
+			};
+			thread_local Context context;
+			if (!context.context)
+				return false;
+
+			const size_t start = out.size();
+			out.resize(start + ZSTD_compressBound(input.size()));
+			const size_t size = ZSTD_compressCCtx(context.context, out.data() + start, out.size() - start,
+				input.data(), input.size(), level);
+			if (ZSTD_isError(size))
+			{
+				out.resize(start);
+				return false;
+			}
+			out.resize(start + size);
+			return true;
+		}
+#endif
+
+#if defined(SIMPLELOGGER_HAS_LZ4)
+		bool compressLz4(int level, std::string_view input, std::string& out)
+		{
+			LZ4F_preferences_t preferences{};
+			preferences.compressionLevel = level;
+			preferences.frameInfo.contentSize = input.size();
+
+			const size_t start = out.size();
+			out.resize(start + LZ4F_compressFrameBound(input.size(), &preferences));
+			const size_t size = LZ4F_compressFrame(out.data() + start, out.size() - start,
+				input.data(), input.size(), &preferences);
+			if (LZ4F_isError(size))
+			{
+				out.resize(start);
+				return false;
+			}
+			out.resize(start + size);
+			return true;
+		}
+#endif
+	}
+
+	bool codecAvailable(Codec codec)
+	{
+		switch (codec)
+		{
+		case Codec::None:
+			return true;
+		case Codec::Zstd:
+#if defined(SIMPLELOGGER_HAS_ZSTD)
+			return true;
+#else
+			return false;
+#endif
+		case Codec::Lz4:
+#if defined(SIMPLELOGGER_HAS_LZ4)
+			return true;
+#else
+			return false;
+#endif
+		}
+		return false;
+	}
+
+	std::string_view codecExtension(Codec codec)
+	{
+		switch (codec)
+		{
+		case Codec::Zstd:
+			return ".zst";
+		case Codec::Lz4:
+			return ".lz4";
+		case Codec::None:
+			break;
+		}
+		return {};
+	}
+
+	bool compressFrame([[maybe_unused]] const CompressionOptions& options, [[maybe_unused]] std::string_view input, [[maybe_unused]] std::string& out)
+	{
+		switch (options.codec)
+		{
+		case Codec::Zstd:
+#if defined(SIMPLELOGGER_HAS_ZSTD)
+			return compressZstd(options.level, input, out);
+#else
+			return false;
+#endif
+		case Codec::Lz4:
+#if defined(SIMPLELOGGER_HAS_LZ4)
+			return compressLz4(options.level, input, out);
+#else
+			return false;
+#endif
+		case Codec::None:
+			break;
+		}
+		return false;
+	}
+
+	bool compressFile(const CompressionOptions& options, const std::filesystem::path& source, const std::filesystem::path& target)
+	{
+		std::ifstream in(source, std::ios::binary);
+		const std::filesystem::path temporary = target.string() + ".tmp";
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		if (!in || !out)
+			return false;
+
+		std::vector<char> input(FileFrameBytes);
+		std::string frame;
+		bool ok = true;
+		while (ok && in)
+		{
+			in.read(input.data(), static_cast<std::streamsize>(input.size()));
+			const size_t size = static_cast<size_t>(in.gcount());
+			if (size == 0)
+				break;
+			frame.clear();
+			ok = compressFrame(options, std::string_view(input.data(), size), frame)
+				&& out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+		}
+		ok = ok && !in.bad() && out.flush();
+		out.close();
+
+		std::error_code error;
+		if (ok)
+			std::filesystem::rename(temporary, target, error);
+		if (!ok || error)
+		{
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+		return true;
+	}
+
+	std::shared_ptr<TaskThread> compressionPool()
+	{
+		static std::mutex mutex;
+		static std::weak_ptr<TaskThread> shared;
+
+		// Held weakly, so the workers stop once the last sink using them is
+		// gone instead of at static destruction.
+		std::lock_guard lock(mutex);
+		std::shared_ptr<TaskThread> pool = shared.lock();
+		if (!pool)
+		{
+			const size_t threads = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+			pool = std::make_shared<TaskThread>(threads);
+			shared = pool;
+		}
+		return pool;
+	}
+}
@@ -0,0 +1,32 @@
+#include "SimpleLogger/ConsoleSink.h"
+
+namespace SimpleLogger
+{
+	ConsoleSink::ConsoleSink(Stream stream)
+		: m_File(stream == Stream::Stdout ? stdout : stderr)
+	{
+		m_Buffer.reserve(FlushThreshold);
+	}
+
+	ConsoleSink::~ConsoleSink()
+	{
+		flush();
+	}
+
+	void ConsoleSink::write(const LogEvent& event)
+	{
+		m_Buffer.append(event.line);
+		if (m_Buffer.size() >= FlushThreshold)
+			flush();
+	}
+
+	void ConsoleSink::flush()
+	{
+		if (!m_Buffer.empty())
+		{
+			std::fwrite(m_Buffer.data(), 1, m_Buffer.size(), m_File);
+			m_Buffer.clear();
+		}
+		std::fflush(m_File);
+	}
+}
@@ -0,0 +1,370 @@
+#include "SimpleLogger/CrashHandler.h"
+
+#include "SimpleLogger/Backend.h"
+#include "SimpleLogger/Digits.h"
+#include "SimpleLogger/Logger.h"
+#include "SimpleLogger/Registry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define SIMPLELOGGER_HAS_BACKTRACE 1
+#endif
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		CrashHandlerOptions s_Options;
+		std::atomic<bool> s_Installed{ false };
+		std::atomic<bool> s_Crashed{ false };
+		std::terminate_handler s_PreviousTerminate = nullptr;
+		thread_local bool t_Reporting = false;
+
+		// Everything below runs in signal handlers: no allocation, no locks,
+		// output only through write(2).
+		class RawWriter
+		{
+		public:
+			explicit RawWriter(int fd)
+				: m_Fd(fd)
+			{
+			}
+
+			~RawWriter() { flush(); }
+
+			void put(std::string_view text)
+			{
+				while (!text.empty())
+				{
+					if (m_Size == sizeof(m_Buffer))
+						flush();
+					const size_t size = std::min(text.size(), sizeof(m_Buffer) - m_Size);
+					std::memcpy(m_Buffer + m_Size, text.data(), size);
+					m_Size += size;
+					text.remove_prefix(size);
+				}
+			}
+
+			void put(char c) { put(std::string_view(&c, 1)); }
+
+			void putUnsigned(uint64_t value)
+			{
+				char digits[20];
+				put(std::string_view(digits, static_cast<size_t>(detail::writeDecimal(digits, value) - digits)));
+			}
+
+			void putSigned(int64_t value)
+			{
+				if (value < 0)
+					put('-');
+				putUnsigned(value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value));
+			}
+
+			void putHex(uint64_t value)
+			{
+				char digits[16];
+				put("0x");
+				put(std::string_view(digits, static_cast<size_t>(detail::writePowerOfTwo<4>(digits, value) - digits)));
+			}
+
+			// Fixed point with six decimals; exact enough for a crash report.
+			void putDouble(double value)
+			{
+				if (std::isnan(value))
+					return put("nan");
+				if (value < 0)
+				{
+					put('-');
+					value = -value;
+				}
+				if (value >= 1e18)
+					return put("inf");
+
+				uint64_t whole = static_cast<uint64_t>(value);
+				uint64_t fraction = static_cast<uint64_t>((value - static_cast<double>(whole)) * 1e6 + 0.5);
+				if (fraction >= 1'000'000)
+				{
+					whole++;
+					fraction -= 1'000'000;
+				}
+				putUnsigned(whole);
+				put('.');
+				char digits[6];
+				for (int i = 5; i >= 0; i--, fraction /= 10)
+					digits[i] = static_cast<char>('0' + fraction % 10);
+				put(std::string_view(digits, sizeof(digits)));
+			}
+
+			void flush()
+			{
+				const char* data = m_Buffer;
+				while (m_Size > 0)
+				{
+					const auto written = ::write(m_Fd, data, static_cast<unsigned>(m_Size));
+					if (written < 0 && errno == EINTR)
+						continue;
+					if (written <= 0)
+						break;
+					data += written;
+					m_Size -= static_cast<size_t>(written);
+				}
+				m_Size = 0;
+			}
+
+		private:
+			int m_Fd;
+			char m_Buffer[1024];
+			size_t m_Size = 0;
+		};
+
+		void putValue(RawWriter& out, const ArgValue& value)
+		{
+			switch (value.type)
+			{
+			case ArgType::Bool:    out.put(value.b ? "true" : "false"); break;
+			case ArgType::Char:    out.put(value.c); break;
+			case ArgType::Int32:
+			case ArgType::Int64:   out.putSigned(value.i); break;
+			case ArgType::UInt32:
+			case ArgType::UInt64:  out.putUnsigned(value.u); break;
+			case ArgType::Float:   out.putDouble(value.f); break;
+			case ArgType::Double:  out.putDouble(value.d); break;
+			case ArgType::Pointer: out.putHex(value.p); break;
+			default:               out.put(value.s); break;
+			}
+		}
+
+		// Placeholders are filled in order, format specs ignored; fields
+		// follow as " key=value".
+		void writeRecord(RawWriter& out, const Record& record)
+		{
+			if (record.kind != RecordKind::Log)
+				return;
+
+			const Metadata& metadata = *record.metadata;
+			out.put('[');
+			out.put(toString(record.level));
+			out.put("] [");
+			out.put(record.logger->name());
+			out.put("] ");
+
+			const char* in = record.arguments();
+			size_t next = 0;
+			for (const char* p = metadata.format; *p; p++)
+			{
+				if (p[0] == '{' && p[1] == '{')
+				{
+					out.put('{');
+					p++;
+				}
+				else if (p[0] == '}' && p[1] == '}')
+				{
+					out.put('}');
+					p++;
+				}
+				else if (p[0] == '{')
+				{
+					while (p[1] && p[1] != '}')
+						p++;
+					if (p[1])
+						p++;
+					if (next < metadata.argCount && metadata.argTypes[next] != ArgType::StaticKey && metadata.argTypes[next] != ArgType::Key)
+						putValue(out, decodeArgument(metadata.argTypes[next++], in));
+				}
+				else
+				{
+					out.put(*p);
+				}
+			}
+
+			for (; next < metadata.argCount; next++)
+			{
+				const ArgValue value = decodeArgument(metadata.argTypes[next], in);
+				if (value.type == ArgType::Key)
+				{
+					out.put(' ');
+					out.put(value.s);
+					out.put('=');
+				}
+				else
+				{
+					putValue(out, value);
+				}
+			}
+			out.put('\n');
+		}
+
+		void writeBacktrace()
+		{
+#if defined(SIMPLELOGGER_HAS_BACKTRACE)
+			void* frames[64];
+			const int count = ::backtrace(frames, 64);
+			RawWriter(s_Options.fd).put("backtrace:\n");
+			::backtrace_symbols_fd(frames, count, s_Options.fd);
+#endif
+		}
+
+		void report()
+		{
+			if (Backend* backend = Backend::existing())
+			{
+				if (!backend->drainForCrash(s_Options.drainTimeout))
+				{
+					RawWriter out(s_Options.fd);
+					out.put("records not written by the backend:\n");
+					backend->forEachPendingRecord([&](const Record& record) { writeRecord(out, record); });
+				}
+			}
+			if (s_Options.backtrace)
+				writeBacktrace();
+		}
+
+		// Returns true if this thread should go on to report the crash. Other
+		// threads that crash meanwhile wait to be ended with the process.
+		bool beginReport()
+		{
+			if (t_Reporting)
+				return false;
+			t_Reporting = true;
+			if (!s_Crashed.exchange(true))
+				return true;
+			for (;;)
+			{
+#if !defined(_WIN32)
+				::pause();
+#endif
+			}
+		}
+
+		std::string_view signalName(int signal)
+		{
+			switch (signal)
+			{
+			case SIGSEGV: return "SIGSEGV";
+			case SIGABRT: return "SIGABRT";
+			case SIGFPE:  return "SIGFPE";
+			case SIGILL:  return "SIGILL";
+#if defined(SIGBUS)
+			case SIGBUS:  return "SIGBUS";
+#endif
+			}
+			return "signal";
+		}
+
+		void onSignal(int signal)
+		{
+			if (beginReport())
+			{
+				{
+					RawWriter out(s_Options.fd);
+					out.put("\n*** SimpleLogger: caught ");
+					out.put(signalName(signal));
+					out.put(" ***\n");
+				}
+				report();
+			}
+
+			// The signal is blocked until the handler returns, so the re-raised
+			// one is delivered with the default action right after.
+			std::signal(signal, SIG_DFL);
+			std::raise(signal);
+		}
+
+		void onTerminate()
+		{
+			if (beginReport())
+			{
+				RawWriter out(s_Options.fd);
+				out.put("\n*** SimpleLogger: std::terminate called");
+				if (std::exception_ptr exception = std::current_exception())
+				{
+					try
+					{
+						std::rethrow_exception(exception);
+					}
+					catch (const std::exception& e)
+					{
+						out.put(" after an uncaught exception: ");
+						out.put(e.what());
+					}
+					catch (...)
+					{
+						out.put(" after an uncaught exception");
+					}
+				}
+				out.put(" ***\n");
+				out.flush();
+				report();
+			}
+
+			// Usually std::abort; the SIGABRT it raises is passed straight on.
+			if (s_PreviousTerminate)
+				s_PreviousTerminate();
+			std::abort();
+		}
+
+		void flushAtExit()
+		{
+			if (s_Crashed.load() || s_Options.exitFlushTimeout.count() == 0)
+				return;
+			if (!Backend::instance().flush(s_Options.exitFlushTimeout))
+			{
+				RawWriter(s_Options.fd).put("SimpleLogger: flush at exit timed out\n");
+				std::_Exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	void installCrashHandler(CrashHandlerOptions options)
+	{
+		if (s_Installed.exchange(true))
+			return;
+		s_Options = options;
+
+		// Constructed now so they are destroyed after flushAtExit() runs.
+		Backend::instance();
+		Registry::instance();
+		std::atexit(flushAtExit);
+
+#if defined(SIMPLELOGGER_HAS_BACKTRACE)
+		// The first call loads the unwinder, which allocates.
+		void* frame;
+		::backtrace(&frame, 1);
+#endif
+
+		s_PreviousTerminate = std::set_terminate(onTerminate);
+
+#if defined(_WIN32)
+		for (int signal : { SIGSEGV, SIGABRT, SIGFPE, SIGILL })
+			std::signal(signal, onSignal);
+#else
+		static char alternateStack[64 * 1024];
+		stack_t stack{};
+		stack.ss_sp = alternateStack;
+		stack.ss_size = sizeof(alternateStack);
+		::sigaltstack(&stack, nullptr);
+
+		struct sigaction action{};
+		action.sa_handler = onSignal;
+		action.sa_flags = SA_ONSTACK;
+		sigemptyset(&action.sa_mask);
+		for (int signal : { SIGSEGV, SIGBUS, SIGABRT, SIGFPE, SIGILL })
+			::sigaction(signal, &action, nullptr);
+#endif
+	}
+}
@@ -0,0 +1,323 @@
+#include "SimpleLogger/Escape.h"
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMPLELOGGER_HAS_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define SIMPLELOGGER_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMPLELOGGER_HAS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace SimpleLogger::Escape
+{
+	namespace
+	{
+		constexpr char HexDigits[] = "0123456789abcdef";
+
+		// The byte classes the scans look for.
+		enum class Class
+		{
+			Json,    // control characters, '"' and '\\'
+			Logfmt,  // Json plus ' ' and '='
+			Text     // control characters except '\t'
+		};
+
+		template <Class C>
+		inline bool isSpecial(unsigned char c)
+		{
+			if constexpr (C == Class::Text)
+				return c < 0x20 && c != '\t';
+			else if constexpr (C == Class::Json)
+				return c < 0x20 || c == '"' || c == '\\';
+			else
+				return c < 0x20 || c == '"' || c == '\\' || c == ' ' || c == '=';
+		}
+
+		template <Class C>
+		size_t scanScalar(const char* data, size_t size, size_t i)
+		{
+			for (; i < size; i++)
+			{
+				if (isSpecial<C>(static_cast<unsigned char>(data[i])))
+					return i;
+			}
+			return size;
+		}
+
+#if defined(SIMPLELOGGER_HAS_SSE2)
+		// Unsigned bytes below 0x20 are the ones min(v, 0x1f) leaves unchanged.
+		template <Class C>
+		inline __m128i specialMask(__m128i v)
+		{
+			const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+			if constexpr (C == Class::Text)
+				return _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), control);
+
+			__m128i mask = _mm_or_si128(control, _mm_or_si128(
+				_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+			if constexpr (C == Class::Logfmt)
+				mask = _mm_or_si128(mask, _mm_or_si128(
+					_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('='))));
+			return mask;
+		}
+
+		template <Class C>
+		size_t scanSse2(const char* data, size_t size)
+		{
+			size_t i = 0;
+			for (; i + 16 <= size; i += 16)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(specialMask<C>(v)));
+				if (mask != 0)
+					return i + static_cast<size_t>(std::countr_zero(mask));
+			}
+			return scanScalar<C>(data, size, i);
+		}
+#endif
+
+#if defined(SIMPLELOGGER_HAS_AVX2)
+		template <Class C>
+		__attribute__((target("avx2"))) inline __m256i specialMask256(__m256i v)
+		{
+			const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+			if constexpr (C == Class::Text)
+				return _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')), control);
+
+			__m256i mask = _mm256_or_si256(control, _mm256_or_si256(
+				_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))));
+			if constexpr (C == Class::Logfmt)
+				mask = _mm256_or_si256(mask, _mm256_or_si256(
+					_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('='))));
+			return mask;
+		}
+
+		// The tail below 32 bytes goes through the SSE2 kernel.
+		template <Class C>
+		__attribute__((target("avx2"))) size_t scanAvx2(const char* data, size_t size)
+		{
+			size_t i = 0;
+			for (; i + 32 <= size; i += 32)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(specialMask256<C>(v)));
+				if (mask != 0)
+					return i + static_cast<size_t>(std::countr_zero(mask));
+			}
+			return i + scanSse2<C>(data + i, size - i);
+		}
+#endif
+
+#if defined(SIMPLELOGGER_HAS_NEON)
+		template <Class C>
+		inline uint8x16_t specialMask(uint8x16_t v)
+		{
+			const uint8x16_t control = vcltq_u8(v, vdupq_n_u8(0x20));
+			if constexpr (C == Class::Text)
+				return vbicq_u8(control, vceqq_u8(v, vdupq_n_u8('\t')));
+
+			uint8x16_t mask = vorrq_u8(control, vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+			if constexpr (C == Class::Logfmt)
+				mask = vorrq_u8(mask, vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('='))));
+			return mask;
+		}
+
+		// NEON has no movemask; narrowing each 16-bit lane by 4 leaves four
+		// bits per byte in a 64-bit value.
+		template <Class C>
+		size_t scanNeon(const char* data, size_t size)
+		{
+			size_t i = 0;
+			for (; i + 16 <= size; i += 16)
+			{
+				const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+				const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(specialMask<C>(v)), 4);
+				const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+				if (mask != 0)
+					return i + static_cast<size_t>(std::countr_zero(mask) / 4);
+			}
+			return scanScalar<C>(data, size, i);
+		}
+#endif
+
+		template <Class C>
+		size_t scanPortable(const char* data, size_t size)
+		{
+			return scanScalar<C>(data, size, 0);
+		}
+
+		using ScanFunction = size_t (*)(const char*, size_t);
+
+		struct Kernels
+		{
+			Kernel kernel;
+			ScanFunction json;
+			ScanFunction logfmt;
+			ScanFunction text;
+		};
+
+		Kernels kernelsFor(Kernel kernel)
+		{
+			switch (kernel)
+			{
+#if defined(SIMPLELOGGER_HAS_SSE2)
+			case Kernel::Sse2:
+				return { kernel, scanSse2<Class::Json>, scanSse2<Class::Logfmt>, scanSse2<Class::Text> };
+#endif
+#if defined(SIMPLELOGGER_HAS_AVX2)
+			case Kernel::Avx2:
+				return { kernel, scanAvx2<Class::Json>, scanAvx2<Class::Logfmt>, scanAvx2<Class::Text> };
+#endif
+#if defined(SIMPLELOGGER_HAS_NEON)
+			case Kernel::Neon:
+				return { kernel, scanNeon<Class::Json>, scanNeon<Class::Logfmt>, scanNeon<Class::Text> };
+#endif
+			default:
+				return { Kernel::Scalar, scanPortable<Class::Json>, scanPortable<Class::Logfmt>, scanPortable<Class::Text> };
+			}
+		}
+
+		bool supported(Kernel kernel)
+		{
+			switch (kernel)
+			{
+			case Kernel::Scalar:
+				return true;
+#if defined(SIMPLELOGGER_HAS_SSE2)
+			case Kernel::Sse2:
+				return true;
+#endif
+#if defined(SIMPLELOGGER_HAS_AVX2)
+			case Kernel::Avx2:
+				// Checks the CPUID bit and that the OS saves the AVX state.
+				return __builtin_cpu_supports("avx2");
+#endif
+#if defined(SIMPLELOGGER_HAS_NEON)
+			case Kernel::Neon:
+				return true;
+#endif
+			default:
+				return false;
+			}
+		}
+
+		Kernels selectKernels()
+		{
+			for (Kernel kernel : { Kernel::Avx2, Kernel::Sse2, Kernel::Neon })
+			{
+				if (supported(kernel))
+					return kernelsFor(kernel);
+			}
+			return kernelsFor(Kernel::Scalar);
+		}
+
+		Kernels& kernels()
+		{
+			static Kernels s_Kernels = selectKernels();
+			return s_Kernels;
+		}
+
+		void appendEscaped(char c, std::string& out)
+		{
+			switch (c)
+			{
+			case '"':  out.append("\\\""); return;
+			case '\\': out.append("\\\\"); return;
+			case '\b': out.append("\\b"); return;
+			case '\f': out.append("\\f"); return;
+			case '\n': out.append("\\n"); return;
+			case '\r': out.append("\\r"); return;
+			case '\t': out.append("\\t"); return;
+			default:
+			{
+				const unsigned char byte = static_cast<unsigned char>(c);
+				const char escape[6] = { '\\', 'u', '0', '0', HexDigits[byte >> 4], HexDigits[byte & 0xf] };
+				out.append(escape, sizeof(escape));
+				return;
+			}
+			}
+		}
+
+		void appendEscaped(std::string_view value, ScanFunction scan, std::string& out)
+		{
+			while (!value.empty())
+			{
+				const size_t special = scan(value.data(), value.size());
+				out.append(value.data(), special);
+				if (special == value.size())
+					return;
+				appendEscaped(value[special], out);
+				value.remove_prefix(special + 1);
+			}
+		}
+	}
+
+	Kernel activeKernel()
+	{
+		return kernels().kernel;
+	}
+
+	const char* kernelName(Kernel kernel)
+	{
+		switch (kernel)
+		{
+		case Kernel::Scalar: return "scalar";
+		case Kernel::Sse2:   return "sse2";
+		case Kernel::Avx2:   return "avx2";
+		case Kernel::Neon:   return "neon";
+		}
+		return "unknown";
+	}
+
+	bool useKernel(Kernel kernel)
+	{
+		if (!supported(kernel))
+			return false;
+		kernels() = kernelsFor(kernel);
+		return true;
+	}
+
+	size_t findJsonSpecial(const char* data, size_t size)
+	{
+		return kernels().json(data, size);
+	}
+
+	size_t findLogfmtSpecial(const char* data, size_t size)
+	{
+		return kernels().logfmt(data, size);
+	}
+
+	size_t findTextSpecial(const char* data, size_t size)
+	{
+		return kernels().text(data, size);
+	}
+
+	void appendJson(std::string_view value, std::string& out)
+	{
+		appendEscaped(value, kernels().json, out);
+	}
+
+	void appendLogfmt(std::string_view value, std::string& out)
+	{
+		if (!value.empty() && findLogfmtSpecial(value.data(), value.size()) == value.size())
+		{
+			out.append(value);
+			return;
+		}
+		out.push_back('"');
+		appendJson(value, out);
+		out.push_back('"');
+	}
+
+	void appendText(std::string_view value, std::string& out)
+	{
+		appendEscaped(value, kernels().text, out);
+	}
+}
@@ -0,0 +1,147 @@
+#include "SimpleLogger/FileSink.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		size_t pageSize()
+		{
+			const long size = ::sysconf(_SC_PAGESIZE);
+			return size > 0 ? static_cast<size_t>(size) : 4096;
+		}
+
+		// Writes all iovecs, retrying on EINTR and partial writes.
+		bool writeAll(int fd, iovec* iov, int count, size_t& calls)
+		{
+			while (count > 0)
+			{
+				const ssize_t written = ::writev(fd, iov, count);
+				calls++;
+				if (written < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					return false;
+				}
+
+				size_t remaining = static_cast<size_t>(written);
+				while (count > 0 && remaining >= iov->iov_len)
+				{
+					remaining -= iov->iov_len;
+					iov++;
+					count--;
+				}
+				if (count > 0)
+				{
+					iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+					iov->iov_len -= remaining;
+				}
+			}
+			return true;
+		}
+	}
+
+	FileSink::FileSink(const std::filesystem::path& path, FlushPolicy policy, bool truncate)
+		: m_Policy(policy)
+	{
+		const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : O_APPEND);
+		m_Fd = ::open(path.c_str(), flags, 0644);
+		if (m_Fd < 0)
+			throw std::system_error(errno, std::generic_category(), "SimpleLogger: cannot open " + path.string());
+
+		const size_t page = pageSize();
+		const size_t wanted = m_Policy.maxBytes ? m_Policy.maxBytes : 64 * 1024;
+		m_Capacity = (wanted + page - 1) / page * page;
+		m_Buffer = static_cast<char*>(std::aligned_alloc(page, m_Capacity));
+		if (!m_Buffer)
+		{
+			::close(m_Fd);
+			throw std::bad_alloc();
+		}
+	}
+
+	FileSink::~FileSink()
+	{
+		flush();
+		std::free(m_Buffer);
+		::close(m_Fd);
+	}
+
+	void FileSink::write(const LogEvent& event)
+	{
+		append(event.line);
+	}
+
+	void FileSink::append(std::string_view line)
+	{
+		if (m_Size == 0)
+			m_OldestRecord = std::chrono::steady_clock::now();
+
+		if (m_Size + line.size() > m_Capacity)
+		{
+			writeOut(line);
+			return;
+		}
+
+		std::memcpy(m_Buffer + m_Size, line.data(), line.size());
+		m_Size += line.size();
+		m_Records++;
+
+		if ((m_Policy.maxBytes && m_Size >= m_Policy.maxBytes) || (m_Policy.maxRecords && m_Records >= m_Policy.maxRecords))
+			writeOut();
+	}
+
+	bool FileSink::poll()
+	{
+		if (m_Size == 0)
+			return false;
+
+		if (m_Policy.maxLatency.count() == 0 || std::chrono::steady_clock::now() - m_OldestRecord >= m_Policy.maxLatency)
+		{
+			writeOut();
+			return false;
+		}
+		return true;
+	}
+
+	void FileSink::flush()
+	{
+		if (m_Size != 0)
+			writeOut();
+	}
+
+	int FileSink::swapFile(int fd)
+	{
+		const int previous = m_Fd;
+		m_Fd = fd;
+		return previous;
+	}
+
+	void FileSink::writeOut(std::string_view extra)
+	{
+		iovec iov[2];
+		int count = 0;
+		if (m_Size != 0)
+			iov[count++] = { m_Buffer, m_Size };
+		if (!extra.empty())
+			iov[count++] = { const_cast<char*>(extra.data()), extra.size() };
+		beforeWriteOut(m_Size + extra.size());
+
+		// There is nobody to report a failed write to from the backend thread;
+		// the data is dropped rather than retried forever.
+		writeAll(m_Fd, iov, count, m_WriteCalls);
+
+		m_Size = 0;
+		m_Records = 0;
+	}
+}
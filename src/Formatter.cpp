@@ -0,0 +1,448 @@
+#include "SimpleLogger/Formatter.h"
+
+#include "SimpleLogger/Digits.h"
+#include "SimpleLogger/Escape.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		char* writeSigned(char* out, int64_t value)
+		{
+			if (value < 0)
+				*out++ = '-';
+			return detail::writeDecimal(out, value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value));
+		}
+
+		// Writes the prefix (for '#') and digits of magnitude in the spec's
+		// base; digits is set to where zero padding would go.
+		char* writeInteger(char* out, uint64_t magnitude, const FormatSpec& spec, char*& digits)
+		{
+			const char* prefix = "";
+			switch (spec.type)
+			{
+			case 'x': prefix = "0x"; break;
+			case 'X': prefix = "0X"; break;
+			case 'b': prefix = "0b"; break;
+			case 'o': prefix = magnitude != 0 ? "0" : ""; break;
+			default: break;
+			}
+			if (spec.alternate)
+			{
+				for (; *prefix; prefix++)
+					*out++ = *prefix;
+			}
+
+			digits = out;
+			switch (spec.type)
+			{
+			case 'x': return detail::writePowerOfTwo<4>(out, magnitude);
+			case 'X': return detail::writePowerOfTwo<4>(out, magnitude, true);
+			case 'o': return detail::writePowerOfTwo<3>(out, magnitude);
+			case 'b': return detail::writePowerOfTwo<1>(out, magnitude);
+			default:  return detail::writeDecimal(out, magnitude);
+			}
+		}
+
+		template <typename T>
+		char* writeFloating(char* out, char* end, T value, const FormatSpec& spec, char*& digits)
+		{
+			digits = out + (std::signbit(value) ? 1 : 0);
+			std::to_chars_result result{ out, std::errc() };
+			switch (spec.type)
+			{
+			case 'f':
+			case 'F': result = std::to_chars(out, end, value, std::chars_format::fixed, spec.precision < 0 ? 6 : spec.precision); break;
+			case 'e':
+			case 'E': result = std::to_chars(out, end, value, std::chars_format::scientific, spec.precision < 0 ? 6 : spec.precision); break;
+			case 'g':
+			case 'G': result = std::to_chars(out, end, value, std::chars_format::general, spec.precision < 0 ? 6 : spec.precision); break;
+			default:
+				result = spec.precision < 0
+					? std::to_chars(out, end, value)
+					: std::to_chars(out, end, value, std::chars_format::general, spec.precision);
+				break;
+			}
+			// Only fixed notation of huge values can overflow the buffer.
+			if (result.ec != std::errc())
+				result = std::to_chars(out, end, value, std::chars_format::scientific);
+
+			if (spec.type == 'F' || spec.type == 'E' || spec.type == 'G')
+			{
+				for (char* p = out; p != result.ptr; p++)
+				{
+					if (*p >= 'a' && *p <= 'z')
+						*p = static_cast<char>(*p - 'a' + 'A');
+				}
+			}
+			return result.ptr;
+		}
+
+		// Strings are quoted only where they need to be; everything else is
+		// written as in the message.
+		void appendLogfmtValue(const ArgValue& value, std::string& out)
+		{
+			if (value.type == ArgType::String)
+				Escape::appendLogfmt(value.s, out);
+			else if (value.type == ArgType::Char)
+				Escape::appendLogfmt(std::string_view(&value.c, 1), out);
+			else
+				Formatter::appendArgument(value, out);
+		}
+
+		void appendJsonValue(const ArgValue& value, std::string& out)
+		{
+			switch (value.type)
+			{
+			case ArgType::Char:
+				out.push_back('"');
+				Escape::appendJson(std::string_view(&value.c, 1), out);
+				out.push_back('"');
+				return;
+			case ArgType::String:
+			case ArgType::StaticString:
+			case ArgType::Key:
+			case ArgType::StaticKey:
+				out.push_back('"');
+				Escape::appendJson(value.s, out);
+				out.push_back('"');
+				return;
+			case ArgType::Float:
+			case ArgType::Double:
+				// JSON has no NaN or infinity.
+				if (!std::isfinite(value.type == ArgType::Float ? value.f : value.d))
+				{
+					out.append("null");
+					return;
+				}
+				break;
+			case ArgType::Pointer:
+				out.push_back('"');
+				Formatter::appendArgument(value, out);
+				out.push_back('"');
+				return;
+			default:
+				break;
+			}
+			Formatter::appendArgument(value, out);
+		}
+
+		void appendPadded(std::string_view text, const PatternOp& op, std::string& out)
+		{
+			const size_t padding = op.width > text.size() ? op.width - text.size() : 0;
+			if (!op.padRight)
+				out.append(padding, ' ');
+			out.append(text);
+			if (op.padRight)
+				out.append(padding, ' ');
+		}
+
+		// Appends " key=value" for each field, as Text and Logfmt do.
+		void appendLogfmtFields(const ArgType* types, const ArgType* end, const char* payload, std::string& out)
+		{
+			while (types != end)
+			{
+				const ArgValue key = decodeArgument(*types++, payload);
+				out.push_back(' ');
+				out.append(key.s);
+				out.push_back('=');
+				appendLogfmtValue(decodeArgument(*types++, payload), out);
+			}
+		}
+	}
+
+	void Formatter::format(uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out)
+	{
+		const ArgType* types = metadata.argTypes;
+		out.append(m_Timestamp.format(wallTime));
+		out.append(" [");
+		out.append(toString(level));
+		out.append("] [");
+		out.append(loggerName);
+		out.append("] ");
+		formatMessage(metadata.format, types, payload, true, out);
+		appendLogfmtFields(types, metadata.argTypes + metadata.argCount, payload, out);
+		out.push_back('\n');
+	}
+
+	void Formatter::formatJson(uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out)
+	{
+		const ArgType* types = metadata.argTypes;
+		const ArgType* end = metadata.argTypes + metadata.argCount;
+		m_Message.clear();
+		formatMessage(metadata.format, types, payload, false, m_Message);
+
+		out.append("{\"ts\":\"");
+		appendTimestamp(wallTime, out);
+		out.append("\",\"level\":\"");
+		out.append(toString(level));
+		out.append("\",\"logger\":\"");
+		Escape::appendJson(loggerName, out);
+		out.append("\",\"msg\":\"");
+		Escape::appendJson(m_Message, out);
+		out.push_back('"');
+		while (types != end)
+		{
+			const ArgValue key = decodeArgument(*types++, payload);
+			out.append(",\"");
+			Escape::appendJson(key.s, out);
+			out.append("\":");
+			appendJsonValue(decodeArgument(*types++, payload), out);
+		}
+		out.append("}\n");
+	}
+
+	void Formatter::formatLogfmt(uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out)
+	{
+		const ArgType* types = metadata.argTypes;
+		m_Message.clear();
+		formatMessage(metadata.format, types, payload, false, m_Message);
+
+		out.append("ts=");
+		appendTimestamp(wallTime, out);
+		out.append(" level=");
+		out.append(toString(level));
+		out.append(" logger=");
+		Escape::appendLogfmt(loggerName, out);
+		out.append(" msg=");
+		Escape::appendLogfmt(m_Message, out);
+		appendLogfmtFields(types, metadata.argTypes + metadata.argCount, payload, out);
+		out.push_back('\n');
+	}
+
+	void Formatter::formatPattern(const Pattern& pattern, uint64_t wallTime, Level level, std::string_view loggerName, uint32_t thread,
+		std::string_view threadName, const Metadata& metadata, const char* payload, std::string& out)
+	{
+		const std::string_view timestamp = pattern.usesTimestamp() ? m_Timestamp.format(wallTime) : std::string_view();
+		const std::string_view file(metadata.file);
+		const std::string_view fileName = file.substr(file.find_last_of("/\\") + 1);
+
+		for (const PatternOp& op : pattern.ops())
+		{
+			switch (op.field)
+			{
+			case PatternField::Literal:
+				out.append(pattern.text().data() + op.offset, op.length);
+				break;
+			case PatternField::Timestamp:
+				out.append(timestamp.data() + op.offset, op.length);
+				break;
+			case PatternField::Level:
+				appendPadded(toString(level), op, out);
+				break;
+			case PatternField::LevelInitial:
+				appendPadded(toString(level).substr(0, 1), op, out);
+				break;
+			case PatternField::Logger:
+				appendPadded(loggerName, op, out);
+				break;
+			case PatternField::Thread:
+				appendPadded(threadText(thread), op, out);
+				break;
+			case PatternField::ThreadName:
+				appendPadded(threadName.empty() ? threadText(thread) : threadName, op, out);
+				break;
+			case PatternField::Message:
+			{
+				const ArgType* types = metadata.argTypes;
+				const char* arguments = payload;
+				formatMessage(metadata.format, types, arguments, true, out);
+				appendLogfmtFields(types, metadata.argTypes + metadata.argCount, arguments, out);
+				break;
+			}
+			case PatternField::File:
+				out.append(fileName);
+				break;
+			case PatternField::Path:
+				out.append(file);
+				break;
+			case PatternField::Line:
+			case PatternField::FileLine:
+			{
+				if (op.field == PatternField::FileLine)
+				{
+					out.append(fileName);
+					out.push_back(':');
+				}
+				char digits[10];
+				out.append(digits, detail::writeDecimal(digits, metadata.line));
+				break;
+			}
+			}
+		}
+		out.push_back('\n');
+	}
+
+	std::string_view Formatter::threadText(uint32_t thread)
+	{
+		if (thread != m_Thread)
+		{
+			m_Thread = thread;
+			m_ThreadLength = static_cast<size_t>(detail::writeDecimal(m_ThreadText, thread) - m_ThreadText);
+		}
+		return std::string_view(m_ThreadText, m_ThreadLength);
+	}
+
+	void Formatter::format(Layout layout, uint64_t wallTime, Level level, std::string_view loggerName, const Metadata& metadata, const char* payload, std::string& out)
+	{
+		switch (layout)
+		{
+		case Layout::Text:
+		case Layout::Pattern: format(wallTime, level, loggerName, metadata, payload, out); return;
+		case Layout::Json:    formatJson(wallTime, level, loggerName, metadata, payload, out); return;
+		case Layout::Logfmt:  formatLogfmt(wallTime, level, loggerName, metadata, payload, out); return;
+		}
+	}
+
+	void Formatter::formatMessage(std::string_view format, const ArgType*& types, const char*& payload, bool sanitize, std::string& out)
+	{
+		// The format string was validated at compile time, so every "{}" has
+		// a matching argument.
+		size_t literalStart = 0;
+		for (size_t i = 0; i < format.size(); i++)
+		{
+			const char c = format[i];
+			if (c != '{' && c != '}')
+				continue;
+
+			out.append(format.data() + literalStart, i - literalStart);
+			if (c == '{' && format[i + 1] == '}')
+			{
+				const ArgValue value = decodeArgument(*types++, payload);
+				if (sanitize && value.type == ArgType::String)
+					Escape::appendText(value.s, out);
+				else
+					appendArgument(value, out);
+			}
+			else if (c == '{' && format[i + 1] == ':')
+			{
+				const size_t close = format.find('}', i + 2);
+				FormatSpec spec;
+				parseFormatSpec(format.substr(i + 2, close - i - 2), spec);
+				appendArgument(decodeArgument(*types++, payload), spec, sanitize, out);
+				i = close - 1;
+			}
+			else
+				out.push_back(c);
+			i++;
+			literalStart = i + 1;
+		}
+		out.append(format.data() + literalStart, format.size() - literalStart);
+	}
+
+	// Integers use the digit pair table; floating point values are written
+	// by std::to_chars in their shortest round-trip form.
+	void Formatter::appendArgument(const ArgValue& value, std::string& out)
+	{
+		char buffer[32];
+		char* end = buffer;
+
+		switch (value.type)
+		{
+		case ArgType::Bool:    out.append(value.b ? "true" : "false"); return;
+		case ArgType::Char:    out.push_back(value.c); return;
+		case ArgType::StaticString:
+		case ArgType::String:
+		case ArgType::StaticKey:
+		case ArgType::Key:     out.append(value.s); return;
+		case ArgType::Int32:
+		case ArgType::Int64:   end = writeSigned(buffer, value.i); break;
+		case ArgType::UInt32:
+		case ArgType::UInt64:  end = detail::writeDecimal(buffer, value.u); break;
+		case ArgType::Float:   end = std::to_chars(buffer, buffer + sizeof(buffer), value.f).ptr; break;
+		case ArgType::Double:  end = std::to_chars(buffer, buffer + sizeof(buffer), value.d).ptr; break;
+		case ArgType::Pointer:
+			buffer[0] = '0';
+			buffer[1] = 'x';
+			end = detail::writePowerOfTwo<4>(buffer + 2, value.p);
+			break;
+		}
+		out.append(buffer, end);
+	}
+
+	void Formatter::appendArgument(const ArgValue& value, const FormatSpec& spec, bool sanitize, std::string& out)
+	{
+		const size_t start = out.size();
+		// Fixed notation of a double can take over 300 digits; anything that
+		// doesn't fit falls back to scientific.
+		char buffer[128];
+		char* digits = buffer;
+		char* end = buffer;
+		bool numeric = true;
+
+		switch (value.type)
+		{
+		case ArgType::Int32:
+		case ArgType::Int64:
+			if (value.i < 0)
+				*end++ = '-';
+			end = writeInteger(end, value.i < 0 ? 0 - static_cast<uint64_t>(value.i) : static_cast<uint64_t>(value.i), spec, digits);
+			break;
+		case ArgType::UInt32:
+		case ArgType::UInt64:
+			end = writeInteger(end, value.u, spec, digits);
+			break;
+		case ArgType::Float:
+			end = writeFloating(buffer, buffer + sizeof(buffer), value.f, spec, digits);
+			break;
+		case ArgType::Double:
+			end = writeFloating(buffer, buffer + sizeof(buffer), value.d, spec, digits);
+			break;
+		case ArgType::Pointer:
+			*end++ = '0';
+			*end++ = 'x';
+			digits = end;
+			end = detail::writePowerOfTwo<4>(end, value.p, spec.type == 'X');
+			break;
+		case ArgType::String:
+		case ArgType::StaticString:
+			numeric = false;
+			if (sanitize)
+				Escape::appendText(value.s, out);
+			else
+				out.append(value.s);
+			break;
+		default:
+			numeric = false;
+			appendArgument(value, out);
+			break;
+		}
+
+		// Numbers are still in the buffer, so their padding is written
+		// around them; other values are already in out and padded in place.
+		const size_t length = numeric ? static_cast<size_t>(end - buffer) : out.size() - start;
+		const size_t padding = spec.width > length ? spec.width - length : 0;
+		const char align = spec.align != 0 ? spec.align : (numeric ? '>' : '<');
+		const size_t before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+
+		if (numeric && spec.zeroPad && spec.align == 0)
+		{
+			out.append(buffer, digits);
+			out.append(padding, '0');
+			out.append(digits, end);
+			return;
+		}
+
+		if (numeric)
+		{
+			out.append(before, spec.fill);
+			out.append(buffer, end);
+		}
+		else if (before != 0)
+			out.insert(start, before, spec.fill);
+		out.append(padding - before, spec.fill);
+	}
+
+	// The text layout's local timestamp as RFC 3339 has it: a 'T' between
+	// date and time and the UTC offset at the end.
+	void Formatter::appendTimestamp(uint64_t wallTime, std::string& out)
+	{
+		const std::string_view timestamp = m_Timestamp.format(wallTime);
+		out.append(timestamp);
+		out[out.size() - timestamp.size() + 10] = 'T';
+		out.append(m_Timestamp.utcOffset());
+	}
+}
@@ -0,0 +1,50 @@
+#include "SimpleLogger/Logger.h"
+
+#include "SimpleLogger/ConsoleSink.h"
+#include "SimpleLogger/Registry.h"
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		constexpr ArgType s_StringArg[] = { ArgType::String };
+
+		// Metadata for log(): a plain "{}" with the message as its argument.
+		constexpr Metadata s_RuntimeMetadata[] = {
+			{ "{}", "", 0, Level::Trace, 1, s_StringArg },
+			{ "{}", "", 0, Level::Debug, 1, s_StringArg },
+			{ "{}", "", 0, Level::Info, 1, s_StringArg },
+			{ "{}", "", 0, Level::Warn, 1, s_StringArg },
+			{ "{}", "", 0, Level::Error, 1, s_StringArg },
+			{ "{}", "", 0, Level::Critical, 1, s_StringArg },
+			{ "{}", "", 0, Level::Off, 1, s_StringArg },
+		};
+	}
+
+	Logger::Logger(std::string name, std::vector<std::shared_ptr<Sink>> sinks, Level level)
+		: m_QueueLevel(static_cast<uint8_t>(level)), m_Level(static_cast<uint8_t>(level)), m_Name(std::move(name)), m_Sinks(std::move(sinks))
+	{
+		// Make sure the backend is constructed first so that it is destroyed
+		// after this logger during static destruction.
+		Backend::instance();
+	}
+
+	Logger::~Logger()
+	{
+		Backend::instance().flush();
+	}
+
+	void Logger::log(Level level, std::string_view message)
+	{
+		if (!shouldLog(level))
+			return;
+
+		enqueue(level, &s_RuntimeMetadata[static_cast<size_t>(level)], message);
+	}
+
+	Logger& defaultLogger()
+	{
+		static Logger& logger = Registry::instance().getOrCreate("root", { std::make_shared<ConsoleSink>() });
+		return logger;
+	}
+}
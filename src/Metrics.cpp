@@ -0,0 +1,104 @@
+#include "SimpleLogger/Metrics.h"
+
+#include <charconv>
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		void appendNumber(std::string& out, uint64_t value)
+		{
+			char digits[20];
+			out.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+		}
+
+		void appendSeconds(std::string& out, uint64_t nanoseconds)
+		{
+			char digits[32];
+			out.append(digits, std::to_chars(digits, digits + sizeof(digits), static_cast<double>(nanoseconds) / 1e9).ptr);
+		}
+
+		void appendHeader(std::string& out, std::string_view prefix, std::string_view name, std::string_view type, std::string_view help)
+		{
+			out.append("# HELP ").append(prefix).append(name).append(" ").append(help).append("\n");
+			out.append("# TYPE ").append(prefix).append(name).append(" ").append(type).append("\n");
+		}
+
+		void appendValue(std::string& out, std::string_view prefix, std::string_view name, std::string_view type, std::string_view help, uint64_t value)
+		{
+			appendHeader(out, prefix, name, type, help);
+			out.append(prefix).append(name).append(" ");
+			appendNumber(out, value);
+			out.append("\n");
+		}
+
+		void appendSecondsValue(std::string& out, std::string_view prefix, std::string_view name, std::string_view help, uint64_t nanoseconds)
+		{
+			appendHeader(out, prefix, name, "gauge", help);
+			out.append(prefix).append(name).append(" ");
+			appendSeconds(out, nanoseconds);
+			out.append("\n");
+		}
+	}
+
+	namespace detail
+	{
+		Metrics MetricCounters::snapshot() const
+		{
+			Metrics metrics;
+			metrics.records = records.load(std::memory_order_relaxed);
+			metrics.bytes = bytes.load(std::memory_order_relaxed);
+			metrics.dropped = dropped.load(std::memory_order_relaxed);
+			metrics.recordsPerSecond = recordsPerSecond.load(std::memory_order_relaxed);
+			metrics.bytesPerSecond = bytesPerSecond.load(std::memory_order_relaxed);
+			metrics.queueDepth = queueDepth.load(std::memory_order_relaxed);
+			metrics.queueHighWater = queueHighWater.load(std::memory_order_relaxed);
+			metrics.lag = lag.load(std::memory_order_relaxed);
+			metrics.maxLag = maxLag.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < FlushLatencyBuckets; i++)
+				metrics.flushLatency[i] = flushLatency[i].load(std::memory_order_relaxed);
+			metrics.flushLatencySum = flushLatencySum.load(std::memory_order_relaxed);
+			metrics.flushes = flushes.load(std::memory_order_relaxed);
+			return metrics;
+		}
+	}
+
+	std::string formatPrometheus(const Metrics& metrics, std::string_view prefix)
+	{
+		std::string base(prefix);
+		base += '_';
+
+		std::string out;
+		appendValue(out, base, "records_total", "counter", "Log records taken off the queues.", metrics.records);
+		appendValue(out, base, "bytes_total", "counter", "Bytes handed to sinks.", metrics.bytes);
+		appendValue(out, base, "dropped_total", "counter", "Records lost to full queues.", metrics.dropped);
+		appendValue(out, base, "records_per_second", "gauge", "Records per second over the last interval.", metrics.recordsPerSecond);
+		appendValue(out, base, "bytes_per_second", "gauge", "Bytes per second over the last interval.", metrics.bytesPerSecond);
+		appendValue(out, base, "queue_depth", "gauge", "Records pending in all thread queues.", metrics.queueDepth);
+		appendValue(out, base, "queue_high_water", "gauge", "Most records seen pending in one thread queue.", metrics.queueHighWater);
+		appendSecondsValue(out, base, "lag_seconds", "Age of the oldest pending record at the last batch.", metrics.lag);
+		appendSecondsValue(out, base, "max_lag_seconds", "Largest lag seen.", metrics.maxLag);
+
+		// Prometheus buckets are cumulative.
+		appendHeader(out, base, "flush_duration_seconds", "histogram", "Time spent polling or flushing the sinks per backend round.");
+		uint64_t cumulative = 0;
+		for (size_t i = 0; i < FlushLatencyBuckets; i++)
+		{
+			cumulative += metrics.flushLatency[i];
+			out.append(base).append("flush_duration_seconds_bucket{le=\"");
+			if (i + 1 < FlushLatencyBuckets)
+				appendSeconds(out, flushLatencyBound(i));
+			else
+				out.append("+Inf");
+			out.append("\"} ");
+			appendNumber(out, cumulative);
+			out.append("\n");
+		}
+		out.append(base).append("flush_duration_seconds_sum ");
+		appendSeconds(out, metrics.flushLatencySum);
+		out.append("\n").append(base).append("flush_duration_seconds_count ");
+		appendNumber(out, metrics.flushes);
+		out.append("\n");
+		return out;
+	}
+}
@@ -0,0 +1,135 @@
+#include "SimpleLogger/MmapSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace SimpleLogger
+{
+	MmapSink::MmapSink(const std::filesystem::path& path, MmapSinkOptions options)
+		: m_Directory(path.parent_path()), m_Stem(path.stem().string()), m_Extension(path.extension().string()), m_Options(options)
+	{
+		if (m_Directory.empty())
+			m_Directory = ".";
+		m_Options.segmentSize = std::max<size_t>(m_Options.segmentSize, 4096);
+
+		m_Current = openSegment();
+		if (!m_Current.data)
+			throw std::system_error(errno, std::generic_category(), "SimpleLogger: cannot create segment " + m_Current.path.string());
+	}
+
+	MmapSink::~MmapSink()
+	{
+		closeSegment(m_Current, m_Used);
+		// A prepared segment that was never written to is not worth keeping.
+		if (m_Next.data)
+		{
+			const std::filesystem::path unused = m_Next.path;
+			closeSegment(m_Next, 0);
+			std::error_code error;
+			std::filesystem::remove(unused, error);
+		}
+	}
+
+	MmapSink::Segment MmapSink::openSegment()
+	{
+		Segment segment;
+		size_t index = m_NextIndex;
+		do
+		{
+			segment.path = m_Directory / (m_Stem + "." + std::to_string(index++) + m_Extension);
+		} while (std::filesystem::exists(segment.path));
+
+		segment.fd = ::open(segment.path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+		if (segment.fd < 0)
+			return segment;
+
+		// A sparse file would turn a full disk into SIGBUS on the stores, so
+		// without real preallocation there is no segment.
+		const int error = ::posix_fallocate(segment.fd, 0, static_cast<off_t>(m_Options.segmentSize));
+		void* data = error == 0 ? ::mmap(nullptr, m_Options.segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0) : MAP_FAILED;
+		if (data == MAP_FAILED)
+		{
+			const int saved = error != 0 ? error : errno;
+			::close(segment.fd);
+			::unlink(segment.path.c_str());
+			segment.fd = -1;
+			errno = saved;
+			return segment;
+		}
+		segment.data = static_cast<char*>(data);
+		m_NextIndex = index;
+		return segment;
+	}
+
+	void MmapSink::closeSegment(Segment& segment, size_t used)
+	{
+		if (segment.data)
+			::munmap(segment.data, m_Options.segmentSize);
+		if (segment.fd >= 0)
+		{
+			// Drop the unused preallocated tail.
+			if (::ftruncate(segment.fd, static_cast<off_t>(used)) != 0)
+			{
+				// Leaves zero bytes at the end of the file; nothing else to do.
+			}
+			::close(segment.fd);
+		}
+		segment = {};
+	}
+
+	void MmapSink::advance()
+	{
+		closeSegment(m_Current, m_Used);
+		m_Current = m_Next.data ? m_Next : openSegment();
+		m_Next = {};
+		m_Used = 0;
+	}
+
+	void MmapSink::write(const LogEvent& event)
+	{
+		std::string_view line = event.line;
+		// Lines stay in one segment unless they are longer than a segment.
+		if (m_Current.data && m_Used != 0 && line.size() > m_Options.segmentSize - m_Used)
+			advance();
+		while (!line.empty())
+		{
+			// Out of file descriptors or disk space: drop until a segment
+			// can be created again.
+			if (!m_Current.data)
+			{
+				m_Current = openSegment();
+				if (!m_Current.data)
+					return;
+			}
+
+			const size_t chunk = std::min(line.size(), m_Options.segmentSize - m_Used);
+			std::memcpy(m_Current.data + m_Used, line.data(), chunk);
+			m_Used += chunk;
+			line.remove_prefix(chunk);
+
+			if (m_Used == m_Options.segmentSize)
+				advance();
+		}
+	}
+
+	bool MmapSink::poll()
+	{
+		// Prepare the next segment while the backend is between batches, so
+		// that switching never has to wait for fallocate.
+		if (!m_Next.data && m_Used >= m_Options.segmentSize / 4 * 3)
+			m_Next = openSegment();
+		return false;
+	}
+
+	void MmapSink::flush()
+	{
+		if (m_Options.syncOnFlush && m_Current.data)
+			::msync(m_Current.data, m_Used, MS_ASYNC);
+	}
+}
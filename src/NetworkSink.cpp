@@ -0,0 +1,325 @@
+#include "SimpleLogger/NetworkSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <string_view>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		// Longest a connect or send waits for the socket before checking for
+		// stop.
+		constexpr int PollMilliseconds = 100;
+		// Datagrams per sendmmsg call.
+		constexpr size_t MaxMessages = 64;
+	}
+
+	NetworkSink::NetworkSink(NetworkProtocol protocol, std::string host, uint16_t port, NetworkSinkOptions options)
+		: m_Protocol(protocol), m_Host(std::move(host)), m_Port(port), m_Options(options), m_Backoff(options.minBackoff)
+	{
+		m_Thread = std::thread([this] { run(); });
+	}
+
+	NetworkSink::~NetworkSink()
+	{
+		handOver(true);
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_Wakeup.notify_one();
+		m_Thread.join();
+		disconnect();
+	}
+
+	void NetworkSink::write(const LogEvent& event)
+	{
+		const std::string_view line = event.line;
+		if (m_Pending.data.size() + m_OutboxBytes.load(std::memory_order_relaxed) + line.size() > m_Options.maxOutboxBytes)
+		{
+			m_Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		m_Pending.data.append(line);
+		m_Pending.ends.push_back(static_cast<uint32_t>(m_Pending.data.size()));
+	}
+
+	bool NetworkSink::poll()
+	{
+		return !handOver(false);
+	}
+
+	void NetworkSink::flush()
+	{
+		handOver(true);
+		std::unique_lock lock(m_Mutex);
+		m_Drained.wait_for(lock, m_Options.flushTimeout,
+			[this] { return m_OutboxBytes.load(std::memory_order_relaxed) == 0 || m_Down; });
+	}
+
+	bool NetworkSink::handOver(bool wait)
+	{
+		if (m_Pending.ends.empty())
+			return true;
+
+		std::unique_lock lock(m_Mutex, std::defer_lock);
+		if (wait)
+			lock.lock();
+		else if (!lock.try_lock())
+			return false;
+
+		const size_t bytes = m_Pending.data.size();
+		if (m_Queued.ends.empty())
+		{
+			m_Queued.data.swap(m_Pending.data);
+			m_Queued.ends.swap(m_Pending.ends);
+		}
+		else
+		{
+			const uint32_t base = static_cast<uint32_t>(m_Queued.data.size());
+			m_Queued.data.append(m_Pending.data);
+			for (uint32_t end : m_Pending.ends)
+				m_Queued.ends.push_back(base + end);
+		}
+		m_Pending.clear();
+		m_OutboxBytes.fetch_add(bytes, std::memory_order_relaxed);
+		lock.unlock();
+		m_Wakeup.notify_one();
+		return true;
+	}
+
+	void NetworkSink::run()
+	{
+		std::unique_lock lock(m_Mutex);
+		for (;;)
+		{
+			if (m_NextLine == m_Sending.ends.size())
+			{
+				m_Sending.clear();
+				m_NextLine = 0;
+				m_LineOffset = 0;
+				m_Wakeup.wait(lock, [this] { return m_Stopping || !m_Queued.ends.empty(); });
+				if (m_Queued.ends.empty())
+					return;
+				std::swap(m_Sending, m_Queued);
+			}
+			lock.unlock();
+
+			bool ok = m_Socket >= 0 || connect();
+			if (ok)
+				ok = (m_Protocol == NetworkProtocol::Udp ? sendUdp() : sendTcp());
+			if (!ok && m_Stopping)
+				dropUnsent();
+
+			lock.lock();
+			m_Down = !ok;
+			m_Drained.notify_all();
+			if (!ok && !m_Stopping)
+				m_Wakeup.wait_until(lock, m_NextAttempt, [this] { return m_Stopping.load(); });
+		}
+	}
+
+	bool NetworkSink::connect()
+	{
+		if (std::chrono::steady_clock::now() < m_NextAttempt)
+			return false;
+
+		addrinfo hints{};
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = m_Protocol == NetworkProtocol::Udp ? SOCK_DGRAM : SOCK_STREAM;
+		addrinfo* addresses = nullptr;
+		if (getaddrinfo(m_Host.c_str(), std::to_string(m_Port).c_str(), &hints, &addresses) != 0)
+		{
+			failed();
+			return false;
+		}
+
+		for (addrinfo* address = addresses; address; address = address->ai_next)
+		{
+			const int fd = ::socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+			if (fd < 0)
+				continue;
+
+			bool connected = ::connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+			if (!connected && errno == EINPROGRESS)
+				connected = waitConnected(fd);
+
+			if (connected)
+			{
+				freeaddrinfo(addresses);
+				m_Socket = fd;
+				m_Backoff = m_Options.minBackoff;
+				m_Connects.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+			::close(fd);
+		}
+
+		freeaddrinfo(addresses);
+		failed();
+		return false;
+	}
+
+	// Waits in PollMilliseconds steps, so that stopping doesn't wait for
+	// connectTimeout.
+	bool NetworkSink::waitConnected(int fd)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + m_Options.connectTimeout;
+		for (;;)
+		{
+			const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+			if (left.count() <= 0 || m_Stopping.load(std::memory_order_relaxed))
+				return false;
+
+			pollfd entry{ fd, POLLOUT, 0 };
+			const int ready = ::poll(&entry, 1, static_cast<int>(std::min<int64_t>(left.count(), PollMilliseconds)));
+			if (ready > 0)
+			{
+				int error = 0;
+				socklen_t length = sizeof(error);
+				return getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+			}
+			if (ready < 0 && errno != EINTR)
+				return false;
+		}
+	}
+
+	void NetworkSink::disconnect()
+	{
+		if (m_Socket >= 0)
+		{
+			::close(m_Socket);
+			m_Socket = -1;
+		}
+	}
+
+	void NetworkSink::failed()
+	{
+		disconnect();
+		m_NextAttempt = std::chrono::steady_clock::now() + m_Backoff;
+		m_Backoff = std::min(m_Backoff * 2, m_Options.maxBackoff);
+	}
+
+	bool NetworkSink::sendUdp()
+	{
+#if defined(__linux__)
+		mmsghdr messages[MaxMessages];
+#else
+		struct
+		{
+			msghdr msg_hdr;
+		} messages[MaxMessages];
+#endif
+		iovec parts[MaxMessages];
+
+		while (m_NextLine < m_Sending.ends.size())
+		{
+			const size_t count = std::min(MaxMessages, m_Sending.ends.size() - m_NextLine);
+			for (size_t i = 0; i < count; i++)
+			{
+				const size_t start = lineStart(m_NextLine + i);
+				const size_t length = std::min<size_t>(m_Sending.ends[m_NextLine + i] - start, m_Options.maxDatagramSize);
+				parts[i] = { m_Sending.data.data() + start, length };
+				messages[i] = {};
+				messages[i].msg_hdr.msg_iov = &parts[i];
+				messages[i].msg_hdr.msg_iovlen = 1;
+			}
+
+#if defined(__linux__)
+			const int sent = ::sendmmsg(m_Socket, messages, static_cast<unsigned>(count), 0);
+#else
+			// One datagram per call where sendmmsg doesn't exist.
+			const int sent = ::sendmsg(m_Socket, &messages[0].msg_hdr, 0) < 0 ? -1 : 1;
+#endif
+			if (sent > 0)
+			{
+				const size_t start = lineStart(m_NextLine);
+				m_NextLine += static_cast<size_t>(sent);
+				consumed(lineStart(m_NextLine) - start);
+				m_Sent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+				continue;
+			}
+			if (sent < 0 && errno == EINTR)
+				continue;
+			if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable())
+				continue;
+
+			// Typically ECONNREFUSED: an ICMP error for an earlier datagram
+			// says nobody is listening.
+			failed();
+			return false;
+		}
+		return true;
+	}
+
+	bool NetworkSink::sendTcp()
+	{
+		while (m_NextLine < m_Sending.ends.size())
+		{
+			const size_t start = lineStart(m_NextLine) + m_LineOffset;
+			const ssize_t sent = ::send(m_Socket, m_Sending.data.data() + start, m_Sending.data.size() - start, MSG_NOSIGNAL);
+			if (sent > 0)
+			{
+				const size_t end = start + static_cast<size_t>(sent);
+				const size_t firstLine = m_NextLine;
+				while (m_NextLine < m_Sending.ends.size() && m_Sending.ends[m_NextLine] <= end)
+					m_NextLine++;
+				m_LineOffset = end - lineStart(m_NextLine);
+				consumed(static_cast<size_t>(sent));
+				m_Sent.fetch_add(m_NextLine - firstLine, std::memory_order_relaxed);
+				continue;
+			}
+			if (sent < 0 && errno == EINTR)
+				continue;
+			if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable())
+				continue;
+
+			// A new connection can't finish a line the collector got part of.
+			if (m_LineOffset != 0)
+			{
+				consumed(m_Sending.ends[m_NextLine] - start);
+				m_NextLine++;
+				m_LineOffset = 0;
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+			failed();
+			return false;
+		}
+		return true;
+	}
+
+	bool NetworkSink::waitWritable()
+	{
+		for (;;)
+		{
+			pollfd entry{ m_Socket, POLLOUT, 0 };
+			const int ready = ::poll(&entry, 1, PollMilliseconds);
+			if (ready > 0)
+				return true;
+			if (ready < 0 && errno != EINTR)
+				return false;
+			if (m_Stopping.load(std::memory_order_relaxed))
+				return false;
+		}
+	}
+
+	void NetworkSink::consumed(size_t bytes)
+	{
+		m_OutboxBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	void NetworkSink::dropUnsent()
+	{
+		const size_t start = lineStart(m_NextLine) + m_LineOffset;
+		m_Dropped.fetch_add(m_Sending.ends.size() - m_NextLine, std::memory_order_relaxed);
+		consumed(m_Sending.data.size() - start);
+		m_NextLine = m_Sending.ends.size();
+		m_LineOffset = 0;
+	}
+}
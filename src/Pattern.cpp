@@ -0,0 +1,34 @@
+#include "SimpleLogger/Pattern.h"
+
+#include <stdexcept>
+
+namespace SimpleLogger
+{
+	Pattern::Pattern(std::string_view pattern)
+		: m_OwnedText(pattern)
+	{
+		m_OwnedOps.resize(pattern.size() + 1);
+		size_t count = 0;
+		switch (detail::parsePattern(m_OwnedText, m_OwnedOps.data(), count))
+		{
+		case detail::PatternError::None:            break;
+		case detail::PatternError::UnknownFlag:     throw std::invalid_argument("SimpleLogger: unknown flag in pattern \"" + m_OwnedText + "\"");
+		case detail::PatternError::TrailingPercent: throw std::invalid_argument("SimpleLogger: pattern \"" + m_OwnedText + "\" ends with '%'");
+		case detail::PatternError::TooLong:         throw std::invalid_argument("SimpleLogger: pattern is too long");
+		}
+		m_OwnedOps.resize(count);
+		m_OwnedOps.shrink_to_fit();
+
+		m_Text = m_OwnedText;
+		m_Ops = m_OwnedOps;
+		for (const PatternOp& op : m_Ops)
+			m_UsesTimestamp |= op.field == PatternField::Timestamp;
+	}
+
+	Pattern::Pattern(std::string_view text, std::span<const PatternOp> ops)
+		: m_Text(text), m_Ops(ops)
+	{
+		for (const PatternOp& op : m_Ops)
+			m_UsesTimestamp |= op.field == PatternField::Timestamp;
+	}
+}
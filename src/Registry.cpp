@@ -0,0 +1,193 @@
+#include "SimpleLogger/Registry.h"
+
+#include "SimpleLogger/Backend.h"
+
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <sstream>
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		volatile std::sig_atomic_t s_ReloadRequested = 0;
+		std::atomic<bool> s_ReloadInstalled{ false };
+
+		extern "C" void onReloadSignal(int)
+		{
+			s_ReloadRequested = 1;
+		}
+	}
+
+	Registry& Registry::instance()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	Registry::Registry()
+	{
+		// The loggers flush the backend when they are destroyed, so it has to
+		// outlive the registry.
+		Backend::instance();
+	}
+
+	Logger& Registry::getOrCreate(std::string_view name, std::vector<std::shared_ptr<Sink>> sinks, Level level)
+	{
+		std::lock_guard lock(m_Mutex);
+		for (const std::unique_ptr<Logger>& logger : m_Loggers)
+		{
+			if (logger->name() == name)
+				return *logger;
+		}
+
+		if (m_SpecDefault)
+			level = *m_SpecDefault;
+		for (const auto& [specName, specLevel] : m_SpecLevels)
+		{
+			if (specName == name)
+				level = specLevel;
+		}
+
+		m_Loggers.push_back(std::make_unique<Logger>(std::string(name), std::move(sinks), level));
+		return *m_Loggers.back();
+	}
+
+	Logger* Registry::find(std::string_view name)
+	{
+		std::lock_guard lock(m_Mutex);
+		for (const std::unique_ptr<Logger>& logger : m_Loggers)
+		{
+			if (logger->name() == name)
+				return logger.get();
+		}
+		return nullptr;
+	}
+
+	void Registry::addSink(std::string name, std::shared_ptr<Sink> sink)
+	{
+		std::lock_guard lock(m_Mutex);
+		for (auto& [sinkName, existing] : m_Sinks)
+		{
+			if (sinkName == name)
+			{
+				existing = std::move(sink);
+				return;
+			}
+		}
+		m_Sinks.emplace_back(std::move(name), std::move(sink));
+	}
+
+	std::shared_ptr<Sink> Registry::findSink(std::string_view name)
+	{
+		std::lock_guard lock(m_Mutex);
+		for (const auto& [sinkName, sink] : m_Sinks)
+		{
+			if (sinkName == name)
+				return sink;
+		}
+		return nullptr;
+	}
+
+	bool Registry::setLevel(std::string_view name, Level level)
+	{
+		Logger* logger = find(name);
+		if (!logger)
+			return false;
+		logger->setLevel(level);
+		return true;
+	}
+
+	void Registry::setAllLevels(Level level)
+	{
+		std::lock_guard lock(m_Mutex);
+		for (const std::unique_ptr<Logger>& logger : m_Loggers)
+			logger->setLevel(level);
+	}
+
+	bool Registry::applyLevelSpec(std::string_view spec)
+	{
+		bool valid = true;
+		size_t position = 0;
+		while (position < spec.size())
+		{
+			const size_t end = spec.find_first_of(", \t\r\n", position);
+			const std::string_view entry = spec.substr(position, end == std::string_view::npos ? std::string_view::npos : end - position);
+			position = end == std::string_view::npos ? spec.size() : end + 1;
+			if (entry.empty())
+				continue;
+
+			const size_t equals = entry.find('=');
+			const std::string_view name = equals == std::string_view::npos ? std::string_view() : entry.substr(0, equals);
+			const std::optional<Level> level = parseLevel(equals == std::string_view::npos ? entry : entry.substr(equals + 1));
+			if (!level)
+			{
+				valid = false;
+				continue;
+			}
+
+			std::lock_guard lock(m_Mutex);
+			if (name.empty())
+			{
+				m_SpecDefault = *level;
+				m_SpecLevels.clear();
+			}
+			else
+			{
+				std::erase_if(m_SpecLevels, [name](const auto& item) { return item.first == name; });
+				m_SpecLevels.emplace_back(std::string(name), *level);
+			}
+
+			for (const std::unique_ptr<Logger>& logger : m_Loggers)
+			{
+				if (name.empty() || logger->name() == name)
+					logger->setLevel(*level);
+			}
+		}
+		return valid;
+	}
+
+	void Registry::reloadLevelsOnSignal(std::filesystem::path file, int signal)
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_LevelFile = std::move(file);
+		}
+
+		if (signal < 0)
+		{
+#if defined(SIGUSR1)
+			signal = SIGUSR1;
+#else
+			return;
+#endif
+		}
+		std::signal(signal, onReloadSignal);
+		s_ReloadInstalled.store(true, std::memory_order_release);
+	}
+
+	void Registry::reloadLevels()
+	{
+		std::filesystem::path file;
+		{
+			std::lock_guard lock(m_Mutex);
+			file = m_LevelFile;
+		}
+
+		std::ifstream stream(file);
+		if (!stream)
+			return;
+		std::stringstream contents;
+		contents << stream.rdbuf();
+		applyLevelSpec(contents.str());
+	}
+
+	void pollLevelReload()
+	{
+		if (!s_ReloadRequested || !s_ReloadInstalled.load(std::memory_order_acquire))
+			return;
+		s_ReloadRequested = 0;
+		Registry::instance().reloadLevels();
+	}
+}
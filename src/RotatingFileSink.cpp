@@ -0,0 +1,189 @@
+#include "SimpleLogger/RotatingFileSink.h"
+
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SimpleLogger
+{
+	RotatingFileSink::RotatingFileSink(const std::filesystem::path& path, RotationPolicy rotation, FlushPolicy flush)
+		: FileSink(path, flush), m_State(std::make_shared<State>()), m_Housekeeping(std::make_unique<TaskThread>())
+	{
+		m_State->path = path;
+		m_State->nextPath = path.string() + ".next";
+		m_State->policy = rotation;
+		if (!codecAvailable(rotation.compression.codec))
+			throw std::system_error(std::make_error_code(std::errc::not_supported), "SimpleLogger: compression codec not built in");
+		if (rotation.compression.codec != Codec::None)
+			m_Compression = compressionPool();
+
+		std::error_code error;
+		const uintmax_t size = std::filesystem::file_size(path, error);
+		m_FileBytes = error ? 0 : static_cast<size_t>(size);
+		m_Boundary = nextBoundary(std::time(nullptr));
+
+		std::shared_ptr<State> state = m_State;
+		m_Housekeeping->post([state] { prepareNext(*state); });
+	}
+
+	RotatingFileSink::~RotatingFileSink()
+	{
+		flush();
+
+		// Let the housekeeping thread finish, then drop the unused next file.
+		m_Housekeeping.reset();
+		{
+			std::unique_lock lock(m_State->mutex);
+			m_State->idle.wait(lock, [this] { return m_State->compressing == 0; });
+		}
+		const int next = m_State->nextFd.exchange(-1);
+		if (next >= 0)
+		{
+			::close(next);
+			std::error_code error;
+			std::filesystem::remove(m_State->nextPath, error);
+		}
+	}
+
+	void RotatingFileSink::beforeWriteOut(size_t bytes)
+	{
+		const RotationPolicy& policy = m_State->policy;
+		const bool sizeDue = policy.maxBytes && m_FileBytes != 0 && m_FileBytes + bytes > policy.maxBytes;
+		const bool timeDue = policy.interval != RotationPolicy::Interval::None && std::time(nullptr) >= m_Boundary;
+
+		if (sizeDue || timeDue)
+		{
+			const int next = m_State->nextFd.exchange(-1, std::memory_order_acq_rel);
+			if (next >= 0)
+			{
+				const int previous = swapFile(next);
+				m_FileBytes = 0;
+				m_Boundary = nextBoundary(std::time(nullptr));
+				m_Rotations++;
+
+				std::shared_ptr<State> state = m_State;
+				std::shared_ptr<TaskThread> pool = m_Compression;
+				m_Housekeeping->post([state, pool, previous]
+				{
+					archive(state, pool.get(), previous);
+					prepareNext(*state);
+				});
+			}
+		}
+
+		m_FileBytes += bytes;
+	}
+
+	std::time_t RotatingFileSink::nextBoundary(std::time_t now) const
+	{
+		if (m_State->policy.interval == RotationPolicy::Interval::None)
+			return 0;
+
+		std::tm tm{};
+		localtime_r(&now, &tm);
+		tm.tm_sec = 0;
+		tm.tm_min = 0;
+		if (m_State->policy.interval == RotationPolicy::Interval::Hourly)
+		{
+			tm.tm_hour++;
+		}
+		else
+		{
+			tm.tm_hour = 0;
+			tm.tm_mday++;
+		}
+		tm.tm_isdst = -1;
+		return std::mktime(&tm);
+	}
+
+	void RotatingFileSink::prepareNext(State& state)
+	{
+		if (state.nextFd.load(std::memory_order_acquire) >= 0)
+			return;
+
+		const int fd = ::open(state.nextPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+		// On failure rotations are postponed until a later rotation retries.
+		if (fd >= 0)
+			state.nextFd.store(fd, std::memory_order_release);
+	}
+
+	std::filesystem::path RotatingFileSink::archivePath(const State& state, size_t index)
+	{
+		std::filesystem::path path = state.path;
+		path.replace_extension();
+		return path.string() + "." + std::to_string(index) + state.path.extension().string()
+			+ std::string(codecExtension(state.policy.compression.codec));
+	}
+
+	std::filesystem::path RotatingFileSink::rotatedPath(const State& state, uint64_t index)
+	{
+		return state.path.string() + "." + std::to_string(index) + ".rotated";
+	}
+
+	void RotatingFileSink::shiftArchives(State& state)
+	{
+		std::error_code error;
+		size_t last = 0;
+		while (std::filesystem::exists(archivePath(state, last + 1), error))
+			last++;
+
+		const size_t keep = state.policy.keepFiles;
+		for (; keep != 0 && last >= keep; last--)
+			std::filesystem::remove(archivePath(state, last), error);
+		for (size_t index = last; index >= 1; index--)
+			std::filesystem::rename(archivePath(state, index), archivePath(state, index + 1), error);
+	}
+
+	void RotatingFileSink::archive(const std::shared_ptr<State>& state, TaskThread* pool, int previousFd)
+	{
+		// The backend no longer writes to previousFd.
+		::close(previousFd);
+
+		std::error_code error;
+		if (!pool)
+		{
+			shiftArchives(*state);
+			std::filesystem::rename(state->path, archivePath(*state, 1), error);
+			std::filesystem::rename(state->nextPath, state->path, error);
+			return;
+		}
+
+		// Move the file aside so the next rotation can happen before this
+		// one is compressed.
+		const uint64_t index = state->nextRotated++;
+		std::filesystem::rename(state->path, rotatedPath(*state, index), error);
+		std::filesystem::rename(state->nextPath, state->path, error);
+		{
+			std::lock_guard lock(state->mutex);
+			state->compressing++;
+		}
+		pool->post([state, index] { compress(*state, index); });
+	}
+
+	void RotatingFileSink::compress(State& state, uint64_t index)
+	{
+		const std::filesystem::path rotated = rotatedPath(state, index);
+		const std::filesystem::path target = rotated.string() + std::string(codecExtension(state.policy.compression.codec));
+		const bool ok = compressFile(state.policy.compression, rotated, target);
+
+		std::lock_guard lock(state.mutex);
+		state.compressed[index] = ok;
+		for (auto it = state.compressed.begin(); it != state.compressed.end() && it->first == state.nextInstall;
+			it = state.compressed.erase(it))
+		{
+			if (it->second)
+			{
+				std::error_code error;
+				shiftArchives(state);
+				std::filesystem::rename(rotatedPath(state, it->first).string() + std::string(codecExtension(state.policy.compression.codec)),
+					archivePath(state, 1), error);
+				std::filesystem::remove(rotatedPath(state, it->first), error);
+			}
+			state.nextInstall++;
+			state.compressing--;
+		}
+		state.idle.notify_all();
+	}
+}
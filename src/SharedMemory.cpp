@@ -0,0 +1,487 @@
+#include "SimpleLogger/SharedMemory.h"
+
+#include "SimpleLogger/Logger.h"
+#include "SimpleLogger/Platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SimpleLogger
+{
+	namespace detail
+	{
+		// The segment is one SharedSegmentHeader followed by its rings, each
+		// a SharedRingHeader followed by ringSize bytes of frames. Fields
+		// shared between processes are only accessed through atomic_ref.
+		struct alignas(CacheLineSize) SharedSegmentHeader
+		{
+			uint64_t magic;      // stored last by the collector that creates it
+			uint32_t rings;
+			uint32_t reserved;
+			uint64_t ringSize;
+			uint64_t epoch;      // bumped by every collector that attaches
+		};
+
+		struct alignas(CacheLineSize) SharedRingHeader
+		{
+			uint32_t state;      // RingState
+			uint32_t pid;
+			uint64_t dropped;
+			alignas(CacheLineSize) uint64_t tail;   // written by the process
+			alignas(CacheLineSize) uint64_t head;   // written by the collector
+		};
+	}
+
+	namespace
+	{
+		using detail::SharedRingHeader;
+		using detail::SharedSegmentHeader;
+
+		// "SLOGSHM1" in memory order.
+		constexpr uint64_t SegmentMagic = 0x314d48534f474c53;
+
+		enum RingState : uint32_t
+		{
+			RingFree,
+			RingOwned,
+			// The process detached; freed once drained.
+			RingClosed
+		};
+
+		// A frame is a uint32_t length followed by the entries of one
+		// record, padded to FrameAlignment. A frame never wraps: the rest of
+		// the ring is skipped with a Padding word instead. StreamStart marks
+		// the first frame of a new Encoder stream.
+		constexpr uint32_t StreamStart = 1u << 31;
+		constexpr uint32_t Padding = UINT32_MAX;
+		constexpr uint64_t FrameAlignment = 8;
+		constexpr size_t MaxRingSize = size_t(1) << 30;
+
+		// Records written per poll() before the sinks get polled.
+		constexpr size_t MaxBatch = 4096;
+		// How often rings that stay empty are checked for a dead process.
+		constexpr std::chrono::seconds LivenessInterval{ 1 };
+
+		uint64_t frameSize(size_t length)
+		{
+			return (sizeof(uint32_t) + length + FrameAlignment - 1) & ~(FrameAlignment - 1);
+		}
+
+		size_t segmentSize(uint64_t rings, uint64_t ringSize)
+		{
+			return sizeof(SharedSegmentHeader) + rings * (sizeof(SharedRingHeader) + ringSize);
+		}
+
+		SharedRingHeader* ringHeader(void* segment, uint64_t ringSize, uint32_t index)
+		{
+			char* base = static_cast<char*>(segment) + sizeof(SharedSegmentHeader);
+			return reinterpret_cast<SharedRingHeader*>(base + index * (sizeof(SharedRingHeader) + ringSize));
+		}
+
+		char* ringData(SharedRingHeader* ring)
+		{
+			return reinterpret_cast<char*>(ring + 1);
+		}
+
+		template <typename T>
+		std::atomic_ref<T> shared(T& value)
+		{
+			return std::atomic_ref<T>(value);
+		}
+
+		bool processExited(uint32_t pid)
+		{
+			return ::kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH;
+		}
+
+		[[noreturn]] void fail(int error, const std::string& what, const std::string& name)
+		{
+			throw std::system_error(error, std::generic_category(), "SimpleLogger: " + what + " " + name);
+		}
+	}
+
+	SharedMemorySink::SharedMemorySink(const std::string& name)
+	{
+		const int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+		if (fd < 0)
+			fail(errno, "cannot open shared memory segment", name);
+
+		struct stat status;
+		if (::fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(SharedSegmentHeader))
+		{
+			::close(fd);
+			fail(EINVAL, "no collector has set up shared memory segment", name);
+		}
+		m_SegmentSize = static_cast<size_t>(status.st_size);
+		void* segment = ::mmap(nullptr, m_SegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		const int error = errno;
+		::close(fd);
+		if (segment == MAP_FAILED)
+			fail(error, "cannot map shared memory segment", name);
+		m_Segment = segment;
+		m_Header = static_cast<SharedSegmentHeader*>(segment);
+
+		if (shared(m_Header->magic).load(std::memory_order_acquire) != SegmentMagic
+			|| segmentSize(m_Header->rings, m_Header->ringSize) > m_SegmentSize)
+		{
+			::munmap(m_Segment, m_SegmentSize);
+			fail(EINVAL, "no collector has set up shared memory segment", name);
+		}
+		m_RingSize = m_Header->ringSize;
+
+		for (uint32_t i = 0; i < m_Header->rings && !m_Ring; i++)
+		{
+			SharedRingHeader* ring = ringHeader(m_Segment, m_RingSize, i);
+			uint32_t state = RingFree;
+			if (shared(ring->state).compare_exchange_strong(state, RingOwned, std::memory_order_acquire))
+				m_Ring = ring;
+		}
+		if (!m_Ring)
+		{
+			::munmap(m_Segment, m_SegmentSize);
+			fail(EBUSY, "every ring is taken in shared memory segment", name);
+		}
+
+		shared(m_Ring->pid).store(static_cast<uint32_t>(::getpid()), std::memory_order_relaxed);
+		m_Data = ringData(m_Ring);
+		m_Tail = shared(m_Ring->tail).load(std::memory_order_relaxed);
+		m_Epoch = shared(m_Header->epoch).load(std::memory_order_relaxed);
+	}
+
+	SharedMemorySink::~SharedMemorySink()
+	{
+		// Release orders the last frame before the state change, so the
+		// collector drains everything before freeing the ring.
+		shared(m_Ring->state).store(RingClosed, std::memory_order_release);
+		::munmap(m_Segment, m_SegmentSize);
+	}
+
+	void SharedMemorySink::write(const LogEvent& event)
+	{
+		// A new collector doesn't know the formats defined so far.
+		const uint64_t epoch = shared(m_Header->epoch).load(std::memory_order_relaxed);
+		if (epoch != m_Epoch)
+		{
+			m_Epoch = epoch;
+			m_StreamStart = true;
+		}
+		if (m_StreamStart)
+			m_Encoder.reset();
+
+		m_Frame.clear();
+		m_Encoder.encode(event, m_Frame);
+		if (push(m_StreamStart))
+		{
+			m_StreamStart = false;
+			return;
+		}
+
+		// The definitions in the frame are lost with it.
+		m_StreamStart = true;
+		shared(m_Ring->dropped).fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool SharedMemorySink::push(bool streamStart)
+	{
+		const uint64_t size = frameSize(m_Frame.size());
+		const uint64_t offset = m_Tail & (m_RingSize - 1);
+		const uint64_t contiguous = m_RingSize - offset;
+		const uint64_t needed = size > contiguous ? contiguous + size : size;
+		if (m_Tail + needed - shared(m_Ring->head).load(std::memory_order_acquire) > m_RingSize)
+			return false;
+
+		char* out = m_Data + offset;
+		if (size > contiguous)
+		{
+			std::memcpy(out, &Padding, sizeof(Padding));
+			out = m_Data;
+		}
+		const uint32_t word = static_cast<uint32_t>(m_Frame.size()) | (streamStart ? StreamStart : 0);
+		std::memcpy(out, &word, sizeof(word));
+		std::memcpy(out + sizeof(word), m_Frame.data(), m_Frame.size());
+
+		m_Tail += needed;
+		shared(m_Ring->tail).store(m_Tail, std::memory_order_release);
+		return true;
+	}
+
+	uint64_t SharedMemorySink::droppedRecords() const
+	{
+		return shared(m_Ring->dropped).load(std::memory_order_relaxed);
+	}
+
+	SharedMemoryCollector::SharedMemoryCollector(const std::string& name, std::vector<std::shared_ptr<Sink>> sinks, SharedMemoryOptions options)
+		: m_Sinks(std::move(sinks))
+	{
+		const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+		if (fd < 0)
+			fail(errno, "cannot open shared memory segment", name);
+
+		struct stat status;
+		if (::fstat(fd, &status) != 0)
+		{
+			const int error = errno;
+			::close(fd);
+			fail(error, "cannot open shared memory segment", name);
+		}
+
+		// An existing segment keeps its geometry, the rings may be in use.
+		uint32_t rings = std::max<uint32_t>(options.processes, 1);
+		uint64_t ringSize = std::bit_ceil(std::clamp<size_t>(options.ringSize, 4096, MaxRingSize));
+		const bool created = status.st_size == 0;
+		if (created)
+		{
+			m_SegmentSize = segmentSize(rings, ringSize);
+			if (::ftruncate(fd, static_cast<off_t>(m_SegmentSize)) != 0)
+			{
+				const int error = errno;
+				::close(fd);
+				fail(error, "cannot size shared memory segment", name);
+			}
+		}
+		else
+		{
+			m_SegmentSize = static_cast<size_t>(status.st_size);
+		}
+
+		void* segment = ::mmap(nullptr, m_SegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		const int error = errno;
+		::close(fd);
+		if (segment == MAP_FAILED)
+			fail(error, "cannot map shared memory segment", name);
+		m_Segment = segment;
+
+		SharedSegmentHeader* header = static_cast<SharedSegmentHeader*>(m_Segment);
+		if (created)
+		{
+			// The new pages are zero: every ring is free and empty.
+			header->rings = rings;
+			header->ringSize = ringSize;
+			shared(header->magic).store(SegmentMagic, std::memory_order_release);
+		}
+		else if (m_SegmentSize < sizeof(SharedSegmentHeader)
+			|| shared(header->magic).load(std::memory_order_acquire) != SegmentMagic
+			|| !std::has_single_bit(header->ringSize)
+			|| segmentSize(header->rings, header->ringSize) > m_SegmentSize)
+		{
+			::munmap(m_Segment, m_SegmentSize);
+			fail(EINVAL, "not a SimpleLogger segment:", name);
+		}
+		rings = header->rings;
+		m_RingSize = header->ringSize;
+		shared(header->epoch).fetch_add(1, std::memory_order_relaxed);
+
+		m_Rings.resize(rings);
+		for (uint32_t i = 0; i < rings; i++)
+		{
+			Ring& ring = m_Rings[i];
+			ring.header = ringHeader(m_Segment, m_RingSize, i);
+			ring.data = ringData(ring.header);
+			ring.head = shared(ring.header->head).load(std::memory_order_relaxed);
+			ring.droppedSeen = shared(ring.header->dropped).load(std::memory_order_relaxed);
+		}
+	}
+
+	SharedMemoryCollector::~SharedMemoryCollector()
+	{
+		flush();
+		::munmap(m_Segment, m_SegmentSize);
+	}
+
+	bool SharedMemoryCollector::remove(const std::string& name)
+	{
+		return ::shm_unlink(name.c_str()) == 0;
+	}
+
+	size_t SharedMemoryCollector::poll()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const bool checkLiveness = now - m_LastLivenessCheck >= LivenessInterval;
+		if (checkLiveness)
+			m_LastLivenessCheck = now;
+
+		for (Ring& ring : m_Rings)
+		{
+			if (peek(ring))
+				continue;
+
+			// Acquire pairs with the release of RingClosed; tail is read
+			// again after it, so the last frames can't be missed.
+			const uint32_t state = shared(ring.header->state).load(std::memory_order_acquire);
+			if (state == RingFree || shared(ring.header->tail).load(std::memory_order_acquire) != ring.head)
+				continue;
+			if (state == RingClosed || (checkLiveness && processExited(shared(ring.header->pid).load(std::memory_order_relaxed))))
+				release(ring);
+		}
+
+		size_t written = 0;
+		while (written < MaxBatch)
+		{
+			Ring* oldest = nullptr;
+			for (Ring& ring : m_Rings)
+			{
+				if (ring.pending && (!oldest || ring.record.wallTime < oldest->record.wallTime))
+					oldest = &ring;
+			}
+			if (!oldest)
+				break;
+
+			const BinaryFormat::Decoder::Record& record = oldest->record;
+			auto it = m_Loggers.find(record.logger);
+			if (it == m_Loggers.end())
+				it = m_Loggers.emplace(record.logger, std::make_unique<Logger>(std::string(record.logger), m_Sinks, Level::Trace)).first;
+
+			const LogEvent event{ record.wallTime, record.metadata->level, it->second.get(), record.metadata, record.payload.data(),
+				static_cast<uint32_t>(record.payload.size()), {}, shared(oldest->header->pid).load(std::memory_order_relaxed), {} };
+			dispatch(event);
+			written++;
+
+			oldest->pending = false;
+			peek(*oldest);
+		}
+
+		for (Ring& ring : m_Rings)
+		{
+			const uint64_t dropped = shared(ring.header->dropped).load(std::memory_order_relaxed);
+			m_Dropped += dropped - ring.droppedSeen;
+			ring.droppedSeen = dropped;
+		}
+
+		if (written != 0)
+		{
+			for (const std::shared_ptr<Sink>& sink : m_Sinks)
+				sink->poll();
+		}
+		return written;
+	}
+
+	void SharedMemoryCollector::flush()
+	{
+		for (const std::shared_ptr<Sink>& sink : m_Sinks)
+			sink->flush();
+	}
+
+	// Decodes the ring's next record into ring.record, skipping frames that
+	// can't be decoded. Definitions are kept by the ring's decoder.
+	bool SharedMemoryCollector::peek(Ring& ring)
+	{
+		if (ring.pending)
+			return true;
+
+		const uint64_t tail = shared(ring.header->tail).load(std::memory_order_acquire);
+		while (ring.head != tail)
+		{
+			const uint64_t offset = ring.head & (m_RingSize - 1);
+			const uint64_t contiguous = m_RingSize - offset;
+			uint32_t word;
+			std::memcpy(&word, ring.data + offset, sizeof(word));
+			if (word == Padding)
+			{
+				ring.head += contiguous;
+				continue;
+			}
+
+			const uint32_t length = word & ~StreamStart;
+			const uint64_t end = ring.head + frameSize(length);
+			if (frameSize(length) > contiguous || end - ring.head > tail - ring.head)
+			{
+				// Garbage; nothing after it can be trusted either.
+				ring.synced = false;
+				ring.head = tail;
+				m_Dropped++;
+				break;
+			}
+
+			if (word & StreamStart)
+			{
+				ring.decoder.reset();
+				ring.synced = true;
+			}
+
+			// Decoded from a copy: the writer can't change what was checked.
+			ring.frame.assign(ring.data + offset + sizeof(word), length);
+			ring.head = end;
+
+			BinaryFormat::Decoder::Result result = BinaryFormat::Decoder::Result::Definition;
+			BinaryFormat::Reader reader(ring.frame.data(), ring.frame.size());
+			while (ring.synced && !reader.atEnd() && result == BinaryFormat::Decoder::Result::Definition)
+				result = ring.decoder.read(reader, ring.record);
+			if (result == BinaryFormat::Decoder::Result::Corrupt)
+				ring.synced = false;
+
+			if (result == BinaryFormat::Decoder::Result::Record)
+			{
+				ring.pending = true;
+				break;
+			}
+			m_Dropped++;
+		}
+
+		shared(ring.header->head).store(ring.head, std::memory_order_release);
+		return ring.pending;
+	}
+
+	// Hands a drained ring out again.
+	void SharedMemoryCollector::release(Ring& ring)
+	{
+		shared(ring.header->tail).store(0, std::memory_order_relaxed);
+		shared(ring.header->head).store(0, std::memory_order_relaxed);
+		shared(ring.header->dropped).store(0, std::memory_order_relaxed);
+		shared(ring.header->pid).store(0, std::memory_order_relaxed);
+		shared(ring.header->state).store(RingFree, std::memory_order_release);
+
+		ring.head = 0;
+		ring.synced = false;
+		ring.droppedSeen = 0;
+		ring.decoder.reset();
+	}
+
+	void SharedMemoryCollector::dispatch(const LogEvent& event)
+	{
+		bool formatted[LayoutCount] = {};
+		// As in the backend, Layout::Pattern's line is only shared between
+		// sinks with the same Pattern object.
+		const Pattern* formattedPattern = nullptr;
+		LogEvent copy = event;
+		for (const std::shared_ptr<Sink>& sink : m_Sinks)
+		{
+			if (!sink->accepts(event.level))
+				continue;
+
+			if (sink->wantsText())
+			{
+				const size_t layout = static_cast<size_t>(sink->layout());
+				const Pattern* pattern = sink->layout() == Layout::Pattern ? sink->pattern() : nullptr;
+				std::string& line = m_Lines[layout];
+				if (!formatted[layout] || (pattern && pattern != formattedPattern))
+				{
+					line.clear();
+					if (pattern)
+						m_Formatter.formatPattern(*pattern, event.wallTime, event.level, event.logger->name(), event.thread, event.threadName,
+							*event.metadata, event.payload, line);
+					else
+						m_Formatter.format(sink->layout(), event.wallTime, event.level, event.logger->name(), *event.metadata, event.payload, line);
+					formatted[layout] = true;
+					if (pattern)
+						formattedPattern = pattern;
+				}
+				copy.line = line;
+			}
+			else
+			{
+				copy.line = {};
+			}
+			sink->write(copy);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#include "SimpleLogger/TaskThread.h"
+
+namespace SimpleLogger
+{
+	TaskThread::TaskThread(size_t threads)
+	{
+		m_Threads.reserve(threads);
+		for (size_t i = 0; i < threads; i++)
+			m_Threads.emplace_back([this] { run(); });
+	}
+
+	TaskThread::~TaskThread()
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_Wakeup.notify_all();
+		for (std::thread& thread : m_Threads)
+			thread.join();
+	}
+
+	void TaskThread::post(std::function<void()> task)
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Tasks.push_back(std::move(task));
+		}
+		m_Wakeup.notify_one();
+	}
+
+	void TaskThread::run()
+	{
+		std::unique_lock lock(m_Mutex);
+		for (;;)
+		{
+			m_Wakeup.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Tasks.empty())
+				return;
+
+			std::function<void()> task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#include "SimpleLogger/TimestampFormatter.h"
+
+#include "SimpleLogger/Digits.h"
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		constexpr size_t SecondsOffset = 17;  // "YYYY-MM-DD HH:MM:"
+		constexpr size_t NanosOffset = 20;    // "YYYY-MM-DD HH:MM:SS."
+	}
+
+	std::string_view TimestampFormatter::format(uint64_t wallTime)
+	{
+		const std::time_t second = static_cast<std::time_t>(wallTime / 1'000'000'000);
+		uint32_t nanos = static_cast<uint32_t>(wallTime % 1'000'000'000);
+
+		if (second != m_CachedSecond)
+		{
+			if (second < m_MinuteStart || second >= m_MinuteEnd)
+				updateMinute(second);
+			detail::writeTwoDigits(m_Buffer + SecondsOffset, static_cast<uint32_t>(second - m_MinuteStart));
+			m_CachedSecond = second;
+		}
+
+		char* out = m_Buffer + NanosOffset;
+		out[0] = static_cast<char>('0' + nanos / 100'000'000);
+		nanos %= 100'000'000;
+		detail::writeTwoDigits(out + 1, nanos / 1'000'000);
+		detail::writeTwoDigits(out + 3, nanos / 10'000 % 100);
+		detail::writeTwoDigits(out + 5, nanos / 100 % 100);
+		detail::writeTwoDigits(out + 7, nanos % 100);
+
+		return std::string_view(m_Buffer, Length);
+	}
+
+	void TimestampFormatter::updateMinute(std::time_t second)
+	{
+		std::tm tm{};
+#if defined(_WIN32)
+		localtime_s(&tm, &second);
+#else
+		localtime_r(&second, &tm);
+#endif
+
+		const uint32_t year = static_cast<uint32_t>(tm.tm_year + 1900);
+		detail::writeTwoDigits(m_Buffer, year / 100 % 100);
+		detail::writeTwoDigits(m_Buffer + 2, year % 100);
+		m_Buffer[4] = '-';
+		detail::writeTwoDigits(m_Buffer + 5, static_cast<uint32_t>(tm.tm_mon + 1));
+		m_Buffer[7] = '-';
+		detail::writeTwoDigits(m_Buffer + 8, static_cast<uint32_t>(tm.tm_mday));
+		m_Buffer[10] = ' ';
+		detail::writeTwoDigits(m_Buffer + 11, static_cast<uint32_t>(tm.tm_hour));
+		m_Buffer[13] = ':';
+		detail::writeTwoDigits(m_Buffer + 14, static_cast<uint32_t>(tm.tm_min));
+		m_Buffer[16] = ':';
+		m_Buffer[19] = '.';
+
+#if defined(_WIN32)
+		const long long offset = static_cast<long long>(_mkgmtime(&tm) - second);
+#else
+		const long long offset = tm.tm_gmtoff;
+#endif
+		const uint32_t offsetMinutes = static_cast<uint32_t>((offset < 0 ? -offset : offset) / 60);
+		m_Offset[0] = offset < 0 ? '-' : '+';
+		detail::writeTwoDigits(m_Offset + 1, offsetMinutes / 60);
+		detail::writeTwoDigits(m_Offset + 4, offsetMinutes % 60);
+
+		// Time zone offsets are whole minutes, so the local minute always
+		// starts tm_sec seconds ago. A leap second (tm_sec == 60) is folded
+		// into the next minute.
+		const int sec = tm.tm_sec < 60 ? tm.tm_sec : 59;
+		m_MinuteStart = second - sec;
+		m_MinuteEnd = m_MinuteStart + 60;
+	}
+}
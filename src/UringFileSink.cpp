@@ -0,0 +1,421 @@
+#include "SimpleLogger/UringFileSink.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define SIMPLELOGGER_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace SimpleLogger
+{
+	namespace
+	{
+		// user_data of the fdatasync; writes carry their buffer index.
+		constexpr uint64_t SyncTag = ~uint64_t(0);
+
+		size_t pageSize()
+		{
+			const long size = ::sysconf(_SC_PAGESIZE);
+			return size > 0 ? static_cast<size_t>(size) : 4096;
+		}
+
+		// Writes size bytes at offset, retrying on EINTR and partial writes.
+		// Returns false if the write failed.
+		bool writeAt(int fd, const char* data, size_t size, uint64_t offset, size_t& calls)
+		{
+			while (size > 0)
+			{
+				iovec iov{ const_cast<char*>(data), size };
+				const ssize_t written = ::pwritev(fd, &iov, 1, static_cast<off_t>(offset));
+				calls++;
+				if (written < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					return false;
+				}
+				data += written;
+				size -= static_cast<size_t>(written);
+				offset += static_cast<uint64_t>(written);
+			}
+			return true;
+		}
+	}
+
+	// A minimal io_uring over the raw system calls, as liburing isn't a
+	// dependency: one submission and one completion ring, used from the
+	// backend thread only.
+	struct UringFileSink::Ring
+	{
+#if defined(SIMPLELOGGER_HAS_IO_URING)
+		~Ring()
+		{
+			if (sqes != MAP_FAILED)
+				::munmap(sqes, sqesSize);
+			if (cqMap != MAP_FAILED && cqMap != sqMap)
+				::munmap(cqMap, cqMapSize);
+			if (sqMap != MAP_FAILED)
+				::munmap(sqMap, sqMapSize);
+			if (fd >= 0)
+				::close(fd);
+		}
+
+		// Returns false if io_uring isn't available or lacks the operations
+		// the sink needs.
+		bool setup(unsigned entries)
+		{
+			io_uring_params params{};
+			fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+			if (fd < 0)
+				return false;
+
+			sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (singleMap)
+				sqMapSize = cqMapSize = sqMapSize > cqMapSize ? sqMapSize : cqMapSize;
+
+			sqMap = ::mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+			if (sqMap == MAP_FAILED)
+				return false;
+			cqMap = singleMap ? sqMap : ::mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+			if (cqMap == MAP_FAILED)
+				return false;
+			sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+			if (sqes == MAP_FAILED)
+				return false;
+
+			char* sq = static_cast<char*>(sqMap);
+			sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+			sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+			sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+			sqEntries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+			sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+			char* cq = static_cast<char*>(cqMap);
+			cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+			cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+			cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+			cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+			return supports(IORING_OP_WRITE) && supports(IORING_OP_FSYNC);
+		}
+
+		bool supports(unsigned op)
+		{
+			constexpr unsigned MaxOps = 256;
+			alignas(io_uring_probe) char storage[sizeof(io_uring_probe) + MaxOps * sizeof(io_uring_probe_op)] = {};
+			io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage);
+			if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, MaxOps) < 0)
+				return false;
+			return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+		}
+
+		// Queues sqe; returns false if the submission ring is full.
+		bool push(const io_uring_sqe& sqe)
+		{
+			const unsigned tail = *sqTail;
+			if (tail - std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire) >= sqEntries)
+				return false;
+			sqes[tail & sqMask] = sqe;
+			sqArray[tail & sqMask] = tail & sqMask;
+			std::atomic_ref<unsigned>(*sqTail).store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Submits what was pushed and, with wait, blocks for one completion.
+		void enter(unsigned submit, bool wait)
+		{
+			while (::syscall(__NR_io_uring_enter, fd, submit, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0) < 0 && errno == EINTR)
+			{
+			}
+		}
+
+		template <typename Function>
+		void forEachCompletion(Function function)
+		{
+			unsigned head = *cqHead;
+			const unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+			for (; head != tail; head++)
+				function(cqes[head & cqMask]);
+			std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+		}
+
+		int fd = -1;
+		void* sqMap = MAP_FAILED;
+		size_t sqMapSize = 0;
+		void* cqMap = MAP_FAILED;
+		size_t cqMapSize = 0;
+		io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+		size_t sqesSize = 0;
+
+		unsigned* sqHead = nullptr;
+		unsigned* sqTail = nullptr;
+		unsigned sqMask = 0;
+		unsigned sqEntries = 0;
+		unsigned* sqArray = nullptr;
+
+		unsigned* cqHead = nullptr;
+		unsigned* cqTail = nullptr;
+		unsigned cqMask = 0;
+		io_uring_cqe* cqes = nullptr;
+#endif
+	};
+
+	UringFileSink::UringFileSink(const std::filesystem::path& path, FlushPolicy policy, UringOptions options, bool truncate)
+		: m_Policy(policy), m_Options(options)
+	{
+		const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+		m_Fd = ::open(path.c_str(), flags, 0644);
+		if (m_Fd < 0)
+			throw std::system_error(errno, std::generic_category(), "SimpleLogger: cannot open " + path.string());
+		const off_t end = ::lseek(m_Fd, 0, SEEK_END);
+		m_FileOffset = end > 0 ? static_cast<uint64_t>(end) : 0;
+
+		size_t buffers = 1;
+#if defined(SIMPLELOGGER_HAS_IO_URING)
+		if (m_Options.useUring && m_Options.buffers > 0)
+		{
+			// One entry per buffer, one for the fdatasync and one to spare.
+			auto ring = std::make_unique<Ring>();
+			if (ring->setup(static_cast<unsigned>(m_Options.buffers + 2)))
+			{
+				m_Ring = std::move(ring);
+				buffers = m_Options.buffers;
+			}
+		}
+#endif
+
+		const size_t page = pageSize();
+		const size_t wanted = m_Policy.maxBytes ? m_Policy.maxBytes : 64 * 1024;
+		m_Capacity = (wanted + page - 1) / page * page;
+		m_Buffers.resize(buffers);
+		for (Buffer& buffer : m_Buffers)
+		{
+			buffer.data = static_cast<char*>(std::aligned_alloc(page, m_Capacity));
+			if (!buffer.data)
+			{
+				for (Buffer& allocated : m_Buffers)
+					std::free(allocated.data);
+				::close(m_Fd);
+				throw std::bad_alloc();
+			}
+		}
+		m_LastSync = std::chrono::steady_clock::now();
+	}
+
+	UringFileSink::~UringFileSink()
+	{
+		flush();
+		while (m_SyncInFlight)
+			reap(true);
+		m_Ring.reset();
+		for (Buffer& buffer : m_Buffers)
+			std::free(buffer.data);
+		::close(m_Fd);
+	}
+
+	void UringFileSink::write(const LogEvent& event)
+	{
+		const std::string_view line = event.line;
+		if (m_Buffers[m_Current].size + line.size() > m_Capacity)
+		{
+			submitCurrent();
+			if (line.size() > m_Capacity)
+			{
+				// Rare enough to write directly, after everything before it.
+				flush();
+				writeDirect(line.data(), line.size());
+				return;
+			}
+		}
+
+		Buffer& buffer = m_Buffers[m_Current];
+		if (buffer.size == 0)
+			m_OldestRecord = std::chrono::steady_clock::now();
+		std::memcpy(buffer.data + buffer.size, line.data(), line.size());
+		buffer.size += line.size();
+		m_Records++;
+
+		if ((m_Policy.maxBytes && buffer.size >= m_Policy.maxBytes) || (m_Policy.maxRecords && m_Records >= m_Policy.maxRecords))
+			submitCurrent();
+	}
+
+	bool UringFileSink::poll()
+	{
+		if (m_InFlight != 0 || m_SyncInFlight)
+			reap(false);
+
+		const auto now = std::chrono::steady_clock::now();
+		if (m_Buffers[m_Current].size != 0 && (m_Policy.maxLatency.count() == 0 || now - m_OldestRecord >= m_Policy.maxLatency))
+			submitCurrent();
+
+		const bool syncing = m_Options.syncInterval.count() != 0;
+		if (syncing && m_WrittenSinceSync && !m_SyncInFlight && now - m_LastSync >= m_Options.syncInterval)
+			submitSync();
+
+		return m_Buffers[m_Current].size != 0 || m_InFlight != 0 || m_SyncInFlight || (syncing && m_WrittenSinceSync);
+	}
+
+	void UringFileSink::flush()
+	{
+		submitCurrent();
+		while (m_InFlight != 0)
+			reap(true);
+	}
+
+	void UringFileSink::submitCurrent()
+	{
+		Buffer& buffer = m_Buffers[m_Current];
+		if (buffer.size == 0)
+			return;
+
+		buffer.fileOffset = m_FileOffset;
+		buffer.written = 0;
+		m_FileOffset += buffer.size;
+		m_Records = 0;
+		m_WrittenSinceSync = true;
+
+		if (!m_Ring)
+		{
+			// There is nobody to report a failed write to from the backend
+			// thread; the data is dropped rather than retried forever.
+			writeAt(m_Fd, buffer.data, buffer.size, buffer.fileOffset, m_WriteCalls);
+			buffer.size = 0;
+			return;
+		}
+
+		submitWrite(m_Current);
+		nextBuffer();
+	}
+
+	void UringFileSink::submitWrite([[maybe_unused]] size_t index)
+	{
+#if defined(SIMPLELOGGER_HAS_IO_URING)
+		Buffer& buffer = m_Buffers[index];
+		io_uring_sqe sqe{};
+		sqe.opcode = IORING_OP_WRITE;
+		sqe.fd = m_Fd;
+		sqe.addr = reinterpret_cast<uint64_t>(buffer.data + buffer.written);
+		sqe.len = static_cast<uint32_t>(buffer.size - buffer.written);
+		sqe.off = buffer.fileOffset + buffer.written;
+		sqe.user_data = index;
+		while (!m_Ring->push(sqe))
+			reap(true);
+
+		if (!buffer.inFlight)
+		{
+			buffer.inFlight = true;
+			m_InFlight++;
+		}
+		m_Ring->enter(1, false);
+		m_WriteCalls++;
+#endif
+	}
+
+	void UringFileSink::nextBuffer()
+	{
+		reap(false);
+		for (;;)
+		{
+			for (size_t i = 1; i <= m_Buffers.size(); i++)
+			{
+				const size_t candidate = (m_Current + i) % m_Buffers.size();
+				if (!m_Buffers[candidate].inFlight)
+				{
+					m_Current = candidate;
+					return;
+				}
+			}
+			// Every buffer is with the kernel: the disk is behind by all of
+			// them, and only now does the backend wait.
+			reap(true);
+		}
+	}
+
+	void UringFileSink::reap([[maybe_unused]] bool wait)
+	{
+#if defined(SIMPLELOGGER_HAS_IO_URING)
+		if (!m_Ring)
+			return;
+		if (wait)
+			m_Ring->enter(0, true);
+
+		size_t resubmit[64];
+		size_t resubmitCount = 0;
+		m_Ring->forEachCompletion([&](const io_uring_cqe& cqe)
+		{
+			if (cqe.user_data == SyncTag)
+			{
+				m_SyncInFlight = false;
+				return;
+			}
+
+			Buffer& buffer = m_Buffers[cqe.user_data];
+			if (cqe.res == -EINTR || cqe.res == -EAGAIN || (cqe.res > 0 && buffer.written + static_cast<size_t>(cqe.res) < buffer.size))
+			{
+				if (cqe.res > 0)
+					buffer.written += static_cast<size_t>(cqe.res);
+				if (resubmitCount < std::size(resubmit))
+				{
+					resubmit[resubmitCount++] = cqe.user_data;
+					return;
+				}
+			}
+
+			// Complete, or failed: as with FileSink the data is dropped.
+			buffer.inFlight = false;
+			buffer.size = 0;
+			buffer.written = 0;
+			m_InFlight--;
+		});
+
+		for (size_t i = 0; i < resubmitCount; i++)
+			submitWrite(resubmit[i]);
+#endif
+	}
+
+	void UringFileSink::submitSync()
+	{
+		m_LastSync = std::chrono::steady_clock::now();
+		m_WrittenSinceSync = false;
+#if defined(SIMPLELOGGER_HAS_IO_URING)
+		if (m_Ring)
+		{
+			io_uring_sqe sqe{};
+			sqe.opcode = IORING_OP_FSYNC;
+			sqe.fd = m_Fd;
+			sqe.fsync_flags = IORING_FSYNC_DATASYNC;
+			sqe.user_data = SyncTag;
+			if (m_Ring->push(sqe))
+			{
+				m_SyncInFlight = true;
+				m_Ring->enter(1, false);
+				m_WriteCalls++;
+			}
+			return;
+		}
+#endif
+		::fdatasync(m_Fd);
+	}
+
+	void UringFileSink::writeDirect(const char* data, size_t size)
+	{
+		writeAt(m_Fd, data, size, m_FileOffset, m_WriteCalls);
+		m_FileOffset += size;
+		m_WrittenSinceSync = true;
+	}
+}
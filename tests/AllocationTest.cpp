@@ -0,0 +1,75 @@
+// Checks that the logging path doesn't allocate in steady state: after one
+// warm-up round (thread queue and spill arena creation), logging numbers,
+// short strings and strings too long for a record must not call operator new
+// on the producer thread.
+
+#include "SimpleLogger/SimpleLogger.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace
+{
+	thread_local bool t_Counting = false;
+	std::atomic<size_t> s_Allocations{ 0 };
+
+	// Discards everything, so the backend keeps up without costing much.
+	class NullSink : public SimpleLogger::Sink
+	{
+	public:
+		void write(const SimpleLogger::LogEvent&) override {}
+		void flush() override {}
+	};
+
+	void logRound(SimpleLogger::Logger& logger, const std::string& longText, const std::string& shortText)
+	{
+		for (int i = 0; i < 1000; i++)
+		{
+			LOGGER_INFO(logger, "number {} and {}", i, 0.5 * i);
+			LOGGER_INFO(logger, "short {}", shortText);
+			LOGGER_INFO(logger, "long {} {}", longText, i);
+			logger.log(SimpleLogger::Level::Warn, longText);
+		}
+	}
+}
+
+void* operator new(size_t size)
+{
+	if (t_Counting)
+		s_Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+int main()
+{
+	SimpleLogger::Logger logger("alloc", { std::make_shared<NullSink>() });
+	const std::string longText(1500, 'x');
+	const std::string shortText = "abc";
+
+	logRound(logger, longText, shortText);
+	SimpleLogger::Backend::instance().flush();
+
+	t_Counting = true;
+	for (int round = 0; round < 20; round++)
+		logRound(logger, longText, shortText);
+	t_Counting = false;
+
+	const size_t allocations = s_Allocations.load();
+	std::printf("allocations on the logging path: %zu\n", allocations);
+	return allocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+// simplelogger-collect: drains the shared memory segment that worker
+// processes log to through SharedMemorySink and writes their records to
+// stdout as text, JSON or logfmt lines, until interrupted.
+//
+//   simplelogger-collect /myapp-logs > myapp.log
+//   simplelogger-collect --json /myapp-logs > myapp.jsonl
+
+#include "SimpleLogger/ConsoleSink.h"
+#include "SimpleLogger/SharedMemory.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <thread>
+
+using namespace SimpleLogger;
+
+namespace
+{
+	volatile std::sig_atomic_t s_Stop = 0;
+
+	// Writers don't wake the collector, so an idle one polls at this rate.
+	constexpr std::chrono::milliseconds IdleInterval{ 1 };
+}
+
+int main(int argc, char** argv)
+{
+	Layout layout = Layout::Text;
+	if (argc == 3 && std::strcmp(argv[1], "--json") == 0)
+		layout = Layout::Json;
+	else if (argc == 3 && std::strcmp(argv[1], "--logfmt") == 0)
+		layout = Layout::Logfmt;
+	else if (argc != 2)
+	{
+		std::fprintf(stderr, "usage: %s [--json | --logfmt] <name>\n", argv[0]);
+		return 2;
+	}
+
+	std::signal(SIGINT, [](int) { s_Stop = 1; });
+	std::signal(SIGTERM, [](int) { s_Stop = 1; });
+
+	auto sink = std::make_shared<ConsoleSink>();
+	sink->setLayout(layout);
+	try
+	{
+		SharedMemoryCollector collector(argv[argc - 1], { sink });
+		while (!s_Stop)
+		{
+			if (collector.poll() == 0)
+			{
+				collector.flush();
+				std::this_thread::sleep_for(IdleInterval);
+			}
+		}
+		while (collector.poll() != 0)
+		{
+		}
+		if (collector.droppedRecords() != 0)
+			std::fprintf(stderr, "%s: %llu records dropped\n", argv[0], static_cast<unsigned long long>(collector.droppedRecords()));
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+		return 1;
+	}
+	return 0;
+}
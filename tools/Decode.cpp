@@ -0,0 +1,68 @@
+// simplelogger-decode: turns a file written by BinarySink back into the same
+// text lines the text sinks produce, or into JSON or logfmt lines.
+//
+//   simplelogger-decode app.slog > app.log
+//   simplelogger-decode --json app.slog > app.jsonl
+
+#include "SimpleLogger/BinaryFormat.h"
+#include "SimpleLogger/Formatter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace SimpleLogger;
+
+int main(int argc, char** argv)
+{
+	Layout layout = Layout::Text;
+	if (argc == 3 && std::strcmp(argv[1], "--json") == 0)
+		layout = Layout::Json;
+	else if (argc == 3 && std::strcmp(argv[1], "--logfmt") == 0)
+		layout = Layout::Logfmt;
+	else if (argc != 2)
+	{
+		std::fprintf(stderr, "usage: %s [--json | --logfmt] <file>\n", argv[0]);
+		return 2;
+	}
+	const char* path = argv[argc - 1];
+
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream)
+	{
+		std::fprintf(stderr, "%s: cannot open %s\n", argv[0], path);
+		return 1;
+	}
+	const std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+	BinaryFormat::Reader reader(data.data(), data.size());
+	if (reader.bytes(BinaryFormat::Magic.size()) != BinaryFormat::Magic)
+	{
+		std::fprintf(stderr, "%s: %s is not a SimpleLogger binary log\n", argv[0], path);
+		return 1;
+	}
+
+	BinaryFormat::Decoder decoder;
+	BinaryFormat::Decoder::Record record;
+	Formatter formatter;
+	std::string line;
+	while (!reader.atEnd())
+	{
+		switch (decoder.read(reader, record))
+		{
+		case BinaryFormat::Decoder::Result::Definition:
+			break;
+		case BinaryFormat::Decoder::Result::Record:
+			line.clear();
+			formatter.format(layout, record.wallTime, record.metadata->level, record.logger, *record.metadata, record.payload.data(), line);
+			std::fwrite(line.data(), 1, line.size(), stdout);
+			break;
+		case BinaryFormat::Decoder::Result::Corrupt:
+			std::fprintf(stderr, "%s: corrupt %s entry, stopping\n", argv[0], decoder.corruptEntry());
+			return 1;
+		}
+	}
+	return 0;
+}